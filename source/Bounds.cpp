@@ -0,0 +1,254 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Bounds.hpp"
+#include "Mesh.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+   #define LANGULUS_BOUNDS_SSE 1
+   #include <immintrin.h>
+#else
+   #define LANGULUS_BOUNDS_SSE 0
+#endif
+
+
+namespace Bounding {
+
+   /// Find the minimum and maximum of an array of positions. With SSE, four  
+   /// positions are twelve floats, or three registers, so every register     
+   /// lane always holds the same coordinate, and is reduced only once        
+   ///   @param positions - the positions                                     
+   ///   @param count - number of positions                                   
+   ///   @param min - [out] the smallest coordinates                          
+   ///   @param max - [out] the largest coordinates                           
+   inline void MinMax(const Vec3f* positions, Count count, float (&min)[3], float (&max)[3]) noexcept {
+      static_assert(sizeof(Vec3f) == sizeof(float) * 3,
+         "Positions must be tightly packed");
+      const auto from = reinterpret_cast<const float*>(positions);
+      for (int c = 0; c < 3; ++c) {
+         min[c] = FLT_MAX;
+         max[c] = -FLT_MAX;
+      }
+
+      Offset i = 0;
+   #if LANGULUS_BOUNDS_SSE
+      if (count >= 4) {
+         __m128 lo[3], hi[3];
+         for (int r = 0; r < 3; ++r)
+            lo[r] = hi[r] = _mm_loadu_ps(from + r * 4);
+
+         for (i = 4; i + 4 <= count; i += 4) {
+            for (int r = 0; r < 3; ++r) {
+               const auto v = _mm_loadu_ps(from + i * 3 + r * 4);
+               lo[r] = _mm_min_ps(lo[r], v);
+               hi[r] = _mm_max_ps(hi[r], v);
+            }
+         }
+
+         // Lanes of the three registers hold xyzx, yzxy and zxyz       
+         alignas(16) float l[12], h[12];
+         for (int r = 0; r < 3; ++r) {
+            _mm_store_ps(l + r * 4, lo[r]);
+            _mm_store_ps(h + r * 4, hi[r]);
+         }
+
+         for (int lane = 0; lane < 12; ++lane) {
+            min[lane % 3] = ::std::min(min[lane % 3], l[lane]);
+            max[lane % 3] = ::std::max(max[lane % 3], h[lane]);
+         }
+      }
+   #endif
+
+      for (; i < count; ++i) {
+         for (int c = 0; c < 3; ++c) {
+            min[c] = ::std::min(min[c], from[i * 3 + c]);
+            max[c] = ::std::max(max[c], from[i * 3 + c]);
+         }
+      }
+   }
+
+} // namespace Bounding
+
+
+/// Bound positions with a box, and a sphere around the box center. The       
+/// sphere isn't minimal, but is as tight as the box allows                   
+///   @param positions - the positions                                        
+///   @param count - number of positions                                      
+///   @return the bounds, without a surface area                              
+auto MeshBounds::FromPositions(const Vec3f* positions, Count count) -> MeshBounds {
+   MeshBounds result;
+   if (not count)
+      return result;
+
+   float min[3], max[3];
+   Bounding::MinMax(positions, count, min, max);
+   result.mMin = {min[0], min[1], min[2]};
+   result.mMax = {max[0], max[1], max[2]};
+
+   float center[3];
+   for (int c = 0; c < 3; ++c)
+      center[c] = (min[c] + max[c]) * .5f;
+   result.mCenter = {center[0], center[1], center[2]};
+
+   float radius = 0;
+   for (Offset i = 0; i < count; ++i) {
+      const auto& p = positions[i];
+      const float d[3] {p[0] - center[0], p[1] - center[1], p[2] - center[2]};
+      radius = ::std::max(radius, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+   }
+
+   result.mRadius = ::std::sqrt(radius);
+   return result;
+}
+
+/// Bound only the positions that the indices refer to, so that unused ones,  
+/// like the dummy first vertex of OBJ files, don't inflate the bounds        
+///   @param positions - the positions                                        
+///   @param positionCount - number of positions                              
+///   @param indices - the indices                                            
+///   @param count - number of indices, all positions are bound if zero       
+///   @return the bounds, without a surface area                              
+auto MeshBounds::FromIndexed(
+   const Vec3f* positions, Count positionCount,
+   const uint32_t* indices, Count count
+) -> MeshBounds {
+   if (not count)
+      return FromPositions(positions, positionCount);
+
+   TMany<uint8_t> used;
+   used.Reserve<true>(positionCount);
+   ::std::memset(used.GetRaw(), 0, positionCount);
+
+   Count referenced = 0;
+   Offset first = positionCount, last = 0;
+   for (Offset i = 0; i < count; ++i) {
+      const auto index = indices[i];
+      if (index >= positionCount or used[index])
+         continue;
+
+      used[index] = 1;
+      ++referenced;
+      first = ::std::min<Offset>(first, index);
+      last = ::std::max<Offset>(last, index);
+   }
+
+   if (not referenced)
+      return {};
+
+   // Usually all but a few leading or trailing positions are used      
+   if (referenced == last - first + 1)
+      return FromPositions(positions + first, referenced);
+
+   TMany<Vec3f> gathered;
+   gathered.Reserve(referenced);
+   for (Offset i = first; i <= last; ++i) {
+      if (used[i])
+         gathered << positions[i];
+   }
+   return FromPositions(gathered.GetRaw(), gathered.GetCount());
+}
+
+/// Bound a shape that is known to fill the given box, in closed form         
+///   @param min - the smallest corner of the box                             
+///   @param max - the largest corner of the box                              
+///   @param area - the surface area of the shape                             
+///   @return the bounds, with a sphere around the box                        
+auto MeshBounds::FromBox(const Vec3f& min, const Vec3f& max, float area) -> MeshBounds {
+   MeshBounds result;
+   result.mMin = min;
+   result.mMax = max;
+
+   float radius = 0;
+   float center[3];
+   for (int c = 0; c < 3; ++c) {
+      center[c] = (min[c] + max[c]) * .5f;
+      radius += (max[c] - center[c]) * (max[c] - center[c]);
+   }
+
+   result.mCenter = {center[0], center[1], center[2]};
+   result.mRadius = ::std::sqrt(radius);
+   result.mArea = area;
+   return result;
+}
+
+/// Sum the area of a triangle list                                           
+///   @param positions - the positions                                        
+///   @param positionCount - number of positions                              
+///   @param indices - three indices per triangle                             
+///   @param count - number of indices                                        
+///   @return the area, or zero if any index is out of range                  
+auto MeshBounds::TriangleArea(
+   const Vec3f* positions, Count positionCount,
+   const uint32_t* indices, Count count
+) -> float {
+   double area = 0;
+   for (Offset i = 0; i + 3 <= count; i += 3) {
+      if (indices[i + 0] >= positionCount
+      or  indices[i + 1] >= positionCount
+      or  indices[i + 2] >= positionCount)
+         return 0;
+
+      const auto& a = positions[indices[i + 0]];
+      const auto& b = positions[indices[i + 1]];
+      const auto& c = positions[indices[i + 2]];
+      const float ab[3] {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+      const float ac[3] {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+      const float n[3] {
+         ab[1] * ac[2] - ab[2] * ac[1],
+         ab[2] * ac[0] - ab[0] * ac[2],
+         ab[0] * ac[1] - ab[1] * ac[0]
+      };
+      area += ::std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+   }
+   return static_cast<float>(area * .5);
+}
+
+/// Compute the bounds of a mesh, that doesn't know them in advance           
+///   @param model - the mesh to bound                                        
+void Mesh::GenerateBounds(Mesh* model) {
+   // Bounds are made from other streams, that might be generated, and  
+   // generators that know their shape commit bounds with positions     
+   model->Generate(MetaOf<Traits::Place>());
+   if (model->CountData(MetaOf<Traits::Bounds>()))
+      return;
+
+   const auto positions = model->GatherPositions();
+   if (positions.IsEmpty())
+      return;
+
+   // Only referenced positions are bound. Position indices come first, 
+   // even if attributes are indexed separately                         
+   model->Generate(MetaOf<Traits::Index>());
+   auto indices = model->GatherIndices();
+   auto bounds = MeshBounds::FromIndexed(
+      positions.GetRaw(), positions.GetCount(),
+      indices.GetRaw(), indices.GetCount());
+
+   const auto topology = model->mView.mTopology;
+   if (topology
+   and not topology->CastsTo<A::TriangleStrip>()
+   and topology->CastsTo<A::Triangle>()) {
+      // Triangle lists without indices are sequential                  
+      if (indices.IsEmpty() and not model->GetData<Traits::Index>()) {
+         indices.Reserve<true>(positions.GetCount());
+         for (Offset i = 0; i < indices.GetCount(); ++i)
+            indices[i] = static_cast<uint32_t>(i);
+      }
+
+      bounds.mArea = MeshBounds::TriangleArea(
+         positions.GetRaw(), positions.GetCount(),
+         indices.GetRaw(), indices.GetCount());
+   }
+
+   TMany<MeshBounds> data;
+   data << bounds;
+   model->Commit<Traits::Bounds>(Abandon(data));
+}
@@ -0,0 +1,40 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+
+
+///                                                                           
+///   Bounding volumes of a mesh                                              
+///                                                                           
+/// Computed once and committed as a single element under Traits::Bounds, so  
+/// that culling, broadphase and LOD selection don't have to scan positions   
+/// on their own. Generators that know their shape commit it in closed form   
+/// along with their positions, files commit it while they're loaded, and     
+/// any other mesh computes it on first request - see Mesh::GetBounds         
+///                                                                           
+struct MeshBounds {
+   LANGULUS(NAME) "MeshBounds";
+   LANGULUS(POD) true;
+
+   // Axis-aligned bounding box                                         
+   Vec3f mMin;
+   Vec3f mMax;
+
+   // Bounding sphere, centered on the box                              
+   Vec3f mCenter;
+   float mRadius = 0;
+
+   // Surface area of all triangles, zero for lines and points          
+   float mArea = 0;
+
+   static auto FromPositions(const Vec3f*, Count) -> MeshBounds;
+   static auto FromIndexed(const Vec3f*, Count, const uint32_t*, Count) -> MeshBounds;
+   static auto FromBox(const Vec3f& min, const Vec3f& max, float area) -> MeshBounds;
+   static auto TriangleArea(const Vec3f*, Count, const uint32_t*, Count) -> float;
+};
@@ -0,0 +1,683 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Bvh.hpp"
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+   #define LANGULUS_BVH_SSE 1
+   #include <immintrin.h>
+#else
+   #define LANGULUS_BVH_SSE 0
+#endif
+
+
+namespace Bvh {
+
+   // Buckets of triangle centroids along each axis, where split planes 
+   // are looked for                                                    
+   constexpr Count Bins = 16;
+
+   // Nodes with this many triangles or fewer are always leaves, and    
+   // nodes with more than MaxLeafSize are always split                 
+   constexpr Count LeafSize = 2;
+   constexpr Count MaxLeafSize = 32;
+
+   // Deeper nodes are leaves, so that traversal fits its stack         
+   constexpr Count MaxDepth = 60;
+   constexpr Count StackSize = 64;
+
+   // Subtrees with fewer triangles are built on a single thread, and   
+   // triangles are prepared in chunks of this many                     
+   constexpr Count ParallelSize = 4096;
+   constexpr Count ChunkSize = 16384;
+
+   /// An axis-aligned box, empty by default                                  
+   struct Box {
+      float mMin[3] {FLT_MAX, FLT_MAX, FLT_MAX};
+      float mMax[3] {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+      void Grow(const float (&point)[3]) noexcept {
+         for (int c = 0; c < 3; ++c) {
+            mMin[c] = ::std::min(mMin[c], point[c]);
+            mMax[c] = ::std::max(mMax[c], point[c]);
+         }
+      }
+
+      void Grow(const Box& box) noexcept {
+         for (int c = 0; c < 3; ++c) {
+            mMin[c] = ::std::min(mMin[c], box.mMin[c]);
+            mMax[c] = ::std::max(mMax[c], box.mMax[c]);
+         }
+      }
+
+      /// Half the surface area, which is all the heuristic needs             
+      float Area() const noexcept {
+         if (mMin[0] > mMax[0])
+            return 0;
+
+         const float d[3] {mMax[0] - mMin[0], mMax[1] - mMin[1], mMax[2] - mMin[2]};
+         return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+      }
+
+      float Center(int axis) const noexcept {
+         return (mMin[axis] + mMax[axis]) * .5f;
+      }
+   };
+
+   /// Builds the nodes of a hierarchy in a preallocated array. Children      
+   /// of a node are allocated as a pair, and work on disjoint ranges of      
+   /// triangles, so large subtrees are built concurrently                    
+   struct Builder {
+      Workers&          mWorkers;
+      TMany<BvhNode>&   mNodes;
+      TMany<uint32_t>&  mOrder;
+      TMany<Box>        mBoxes;
+      ::std::atomic<uint32_t> mUsed;
+
+      void Split(uint32_t, uint32_t first, uint32_t count, Count depth);
+   };
+
+   /// Get the bin of a triangle centroid                                     
+   ///   @param center - the centroid coordinate                              
+   ///   @param min - the smallest centroid coordinate in the node            
+   ///   @param scale - bins per unit                                         
+   ///   @return the bin                                                      
+   inline Count BinOf(float center, float min, float scale) noexcept {
+      const auto bin = static_cast<Count>((center - min) * scale);
+      return ::std::min(bin, Bins - 1);
+   }
+
+   inline void Sub(const Vec3f& a, const Vec3f& b, float (&out)[3]) noexcept {
+      for (int c = 0; c < 3; ++c)
+         out[c] = a[c] - b[c];
+   }
+
+   /// Cross product, of floats or of packets                                 
+   template<class T>
+   void Cross(const T (&a)[3], const T (&b)[3], T (&out)[3]) noexcept {
+      out[0] = a[1] * b[2] - a[2] * b[1];
+      out[1] = a[2] * b[0] - a[0] * b[2];
+      out[2] = a[0] * b[1] - a[1] * b[0];
+   }
+
+   /// Dot product, of floats or of packets                                   
+   template<class T>
+   T Dot(const T (&a)[3], const T (&b)[3]) noexcept {
+      return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+   }
+
+   /// Intersect a ray with a node's box                                      
+   ///   @param node - the node                                               
+   ///   @param origin - where the ray starts                                 
+   ///   @param inverse - the inverse of the ray direction                    
+   ///   @param best - the closest hit so far                                 
+   ///   @return the distance the ray enters the box at, or FLT_MAX if it     
+   ///      misses it, or enters it after the closest hit                     
+   inline float Slab(
+      const BvhNode& node, const float (&origin)[3],
+      const float (&inverse)[3], float best
+   ) noexcept {
+      float near = 0;
+      float far = best;
+      for (int c = 0; c < 3; ++c) {
+         auto t0 = (node.mMin[c] - origin[c]) * inverse[c];
+         auto t1 = (node.mMax[c] - origin[c]) * inverse[c];
+         if (t0 > t1)
+            ::std::swap(t0, t1);
+         near = ::std::max(near, t0);
+         far = ::std::min(far, t1);
+      }
+      return near <= far ? near : FLT_MAX;
+   }
+
+   /// Intersect a ray with a triangle, Moller-Trumbore style. Triangles      
+   /// are hit from both sides                                                
+   ///   @param v - the three vertices of the triangle                        
+   ///   @param origin - where the ray starts                                 
+   ///   @param direction - the ray direction                                 
+   ///   @param best - the closest hit so far                                 
+   ///   @param hit - [out] the hit, if closer than the best one              
+   ///   @return true if the triangle was hit closer than the best one        
+   inline bool Triangle(
+      const Vec3f* v, const Vec3f& origin, const float (&direction)[3],
+      float best, RayHit& hit
+   ) noexcept {
+      float e1[3], e2[3], p[3];
+      Sub(v[1], v[0], e1);
+      Sub(v[2], v[0], e2);
+      Cross(direction, e2, p);
+      const auto det = Dot(e1, p);
+      if (det == 0)
+         return false;
+
+      const auto inverse = 1 / det;
+      float s[3], q[3];
+      Sub(origin, v[0], s);
+      const auto u = Dot(s, p) * inverse;
+      if (u < 0 or u > 1)
+         return false;
+
+      Cross(s, e1, q);
+      const auto w = Dot(direction, q) * inverse;
+      if (w < 0 or u + w > 1)
+         return false;
+
+      const auto t = Dot(e2, q) * inverse;
+      if (not (t >= 0 and t < best))
+         return false;
+
+      hit.mDistance = t;
+      hit.mU = u;
+      hit.mV = w;
+      return true;
+   }
+
+} // namespace Bvh
+
+
+/// Make a node out of a range of triangles, and split it in two, where the   
+/// surface area heuristic says it's cheapest to traverse                     
+///   @param index - the node                                                 
+///   @param first - first triangle of the node in mOrder                     
+///   @param count - number of triangles                                      
+///   @param depth - depth of the node                                        
+void Bvh::Builder::Split(uint32_t index, uint32_t first, uint32_t count, Count depth) {
+   Box bounds, centers;
+   for (uint32_t k = first; k < first + count; ++k) {
+      const auto& box = mBoxes[mOrder[k]];
+      bounds.Grow(box);
+      centers.Grow({box.Center(0), box.Center(1), box.Center(2)});
+   }
+
+   auto& node = mNodes[index];
+   for (int c = 0; c < 3; ++c) {
+      node.mMin[c] = bounds.mMin[c];
+      node.mMax[c] = bounds.mMax[c];
+   }
+   node.mFirst = first;
+   node.mCount = count;
+   if (count <= LeafSize or depth >= MaxDepth)
+      return;
+
+   // Find the cheapest plane between bins, along any axis              
+   float bestCost = FLT_MAX;
+   int bestAxis = -1;
+   Count bestBin = 0;
+   for (int axis = 0; axis < 3; ++axis) {
+      const auto extent = centers.mMax[axis] - centers.mMin[axis];
+      if (extent <= 0)
+         continue;
+
+      const auto scale = Bins / extent;
+      Box boxes[Bins];
+      Count counts[Bins] {};
+      for (uint32_t k = first; k < first + count; ++k) {
+         const auto& box = mBoxes[mOrder[k]];
+         const auto bin = BinOf(box.Center(axis), centers.mMin[axis], scale);
+         boxes[bin].Grow(box);
+         ++counts[bin];
+      }
+
+      // Sweep from the right, then evaluate planes from the left       
+      float rightArea[Bins] {};
+      Count rightCount[Bins] {};
+      Box right;
+      Count inRight = 0;
+      for (Count bin = Bins - 1; bin > 0; --bin) {
+         right.Grow(boxes[bin]);
+         inRight += counts[bin];
+         rightArea[bin] = right.Area();
+         rightCount[bin] = inRight;
+      }
+
+      Box left;
+      Count inLeft = 0;
+      for (Count bin = 1; bin < Bins; ++bin) {
+         left.Grow(boxes[bin - 1]);
+         inLeft += counts[bin - 1];
+         if (not inLeft or not rightCount[bin])
+            continue;
+
+         const auto cost = left.Area() * inLeft + rightArea[bin] * rightCount[bin];
+         if (cost < bestCost) {
+            bestCost = cost;
+            bestAxis = axis;
+            bestBin = bin;
+         }
+      }
+   }
+
+   // Splitting must pay for visiting another node                      
+   if (count <= MaxLeafSize and (bestAxis < 0 or bestCost >= bounds.Area() * count))
+      return;
+
+   uint32_t middle;
+   if (bestAxis >= 0) {
+      const auto scale = Bins / (centers.mMax[bestAxis] - centers.mMin[bestAxis]);
+      const auto begin = mOrder.GetRaw() + first;
+      const auto split = ::std::partition(begin, begin + count, [&](uint32_t t) {
+         const auto center = mBoxes[t].Center(bestAxis);
+         return BinOf(center, centers.mMin[bestAxis], scale) < bestBin;
+      });
+      middle = static_cast<uint32_t>(split - mOrder.GetRaw());
+   }
+   else {
+      // All centers coincide, so any split is as good as another       
+      middle = first + count / 2;
+   }
+
+   const auto children = mUsed.fetch_add(2);
+   node.mFirst = children;
+   node.mCount = 0;
+
+   const auto build = [&](Offset child) {
+      if (child == 0)
+         Split(children, first, middle - first, depth + 1);
+      else
+         Split(children + 1, middle, first + count - middle, depth + 1);
+   };
+
+   if (count >= ParallelSize)
+      mWorkers.ForEach(2, build);
+   else {
+      build(0);
+      build(1);
+   }
+}
+
+/// Build a hierarchy over a triangle list                                    
+///   @param positions - the vertex positions                                 
+///   @param indices - three indices per triangle, all in range               
+///   @param workers - threads to build on                                    
+///   @param nodes - [out] the nodes                                          
+///   @param triangles - [out] the original triangle, in leaf order           
+///   @param vertices - [out] triangle vertices, in leaf order                
+void Bvh::Build(
+   const TMany<Vec3f>& positions, const TMany<uint32_t>& indices,
+   Workers& workers, TMany<BvhNode>& nodes, TMany<uint32_t>& triangles,
+   TMany<Vec3f>& vertices
+) {
+   const auto count = indices.GetCount() / 3;
+   if (not count)
+      return;
+
+   // The root is allocated from the start                              
+   Builder builder {workers, nodes, triangles, {}, {1}};
+   builder.mBoxes.Reserve<true>(count);
+   triangles.Reserve<true>(count);
+   const auto chunks = (count + ChunkSize - 1) / ChunkSize;
+   workers.ForEach(chunks, [&](Offset chunk) {
+      const auto end = ::std::min(count, (chunk + 1) * ChunkSize);
+      for (Offset t = chunk * ChunkSize; t < end; ++t) {
+         Box box;
+         for (int v = 0; v < 3; ++v) {
+            const auto& p = positions[indices[t * 3 + v]];
+            box.Grow({p[0], p[1], p[2]});
+         }
+
+         builder.mBoxes[t] = box;
+         triangles[t] = static_cast<uint32_t>(t);
+      }
+   });
+
+   // A binary tree with a triangle or more per leaf has at most this   
+   // many nodes, so nodes never move while they're built               
+   nodes.Reserve<true>(count * 2 - 1);
+   builder.Split(0, 0, static_cast<uint32_t>(count), 0);
+   nodes.Reserve<true>(builder.mUsed.load());
+
+   vertices.Reserve<true>(count * 3);
+   workers.ForEach(chunks, [&](Offset chunk) {
+      const auto end = ::std::min(count, (chunk + 1) * ChunkSize);
+      for (Offset k = chunk * ChunkSize; k < end; ++k) {
+         const auto t = triangles[k];
+         for (int v = 0; v < 3; ++v)
+            vertices[k * 3 + v] = positions[indices[t * 3 + v]];
+      }
+   });
+}
+
+/// Find the closest triangle a ray hits                                      
+///   @param nodes - the hierarchy                                            
+///   @param triangles - the original triangle, in leaf order                 
+///   @param vertices - triangle vertices, in leaf order                      
+///   @param origin - where the ray starts                                    
+///   @param direction - the ray direction                                    
+///   @param maxDistance - hits further than this are ignored                 
+///   @param hit - [out] the closest hit                                      
+///   @return true if a triangle was hit                                      
+bool Bvh::Intersect(
+   const BvhNode* nodes, const uint32_t* triangles, const Vec3f* vertices,
+   const Vec3f& origin, const Vec3f& direction, float maxDistance, RayHit& hit
+) {
+   const float o[3] {origin[0], origin[1], origin[2]};
+   const float d[3] {direction[0], direction[1], direction[2]};
+   float inverse[3];
+   for (int c = 0; c < 3; ++c) {
+      // Avoid infinities, that make NaNs when the ray is in a plane    
+      inverse[c] = d[c] != 0 ? 1 / d[c] : ::std::copysign(FLT_MAX, d[c]);
+   }
+
+   struct Entry {
+      uint32_t mNode;
+      float mNear;
+   };
+
+   Entry stack[StackSize];
+   Count top = 0;
+   float best = maxDistance;
+   bool found = false;
+
+   const auto root = Slab(nodes[0], o, inverse, best);
+   if (root < best)
+      stack[top++] = {0, root};
+
+   while (top) {
+      const auto entry = stack[--top];
+      if (entry.mNear >= best)
+         continue;
+
+      const auto& node = nodes[entry.mNode];
+      if (node.mCount) {
+         for (auto k = node.mFirst; k < node.mFirst + node.mCount; ++k) {
+            if (Triangle(vertices + k * 3, origin, d, best, hit)) {
+               best = hit.mDistance;
+               hit.mTriangle = triangles[k];
+               found = true;
+            }
+         }
+         continue;
+      }
+
+      // Visit the nearer child first, by pushing it last               
+      Entry near {node.mFirst, Slab(nodes[node.mFirst], o, inverse, best)};
+      Entry far {node.mFirst + 1, Slab(nodes[node.mFirst + 1], o, inverse, best)};
+      if (far.mNear < near.mNear)
+         ::std::swap(near, far);
+      if (far.mNear < best)
+         stack[top++] = far;
+      if (near.mNear < best)
+         stack[top++] = near;
+   }
+
+   return found;
+}
+
+#if LANGULUS_BVH_SSE
+namespace Bvh {
+
+   /// Four floats, one for each ray of a packet                              
+   struct Float4 {
+      static constexpr Count Width = 4;
+      __m128 v;
+
+      static Float4 Set(float x) noexcept { return {_mm_set1_ps(x)}; }
+      static Float4 Load(const float* p) noexcept { return {_mm_loadu_ps(p)}; }
+      void Store(float* p) const noexcept { _mm_storeu_ps(p, v); }
+      int Mask() const noexcept { return _mm_movemask_ps(v); }
+
+      friend Float4 operator + (Float4 a, Float4 b) noexcept { return {_mm_add_ps(a.v, b.v)}; }
+      friend Float4 operator - (Float4 a, Float4 b) noexcept { return {_mm_sub_ps(a.v, b.v)}; }
+      friend Float4 operator * (Float4 a, Float4 b) noexcept { return {_mm_mul_ps(a.v, b.v)}; }
+      friend Float4 operator / (Float4 a, Float4 b) noexcept { return {_mm_div_ps(a.v, b.v)}; }
+      friend Float4 operator & (Float4 a, Float4 b) noexcept { return {_mm_and_ps(a.v, b.v)}; }
+      friend Float4 operator <  (Float4 a, Float4 b) noexcept { return {_mm_cmplt_ps(a.v, b.v)}; }
+      friend Float4 operator <= (Float4 a, Float4 b) noexcept { return {_mm_cmple_ps(a.v, b.v)}; }
+      friend Float4 operator >= (Float4 a, Float4 b) noexcept { return {_mm_cmpge_ps(a.v, b.v)}; }
+      friend Float4 operator != (Float4 a, Float4 b) noexcept { return {_mm_cmpneq_ps(a.v, b.v)}; }
+      friend Float4 Min(Float4 a, Float4 b) noexcept { return {_mm_min_ps(a.v, b.v)}; }
+      friend Float4 Max(Float4 a, Float4 b) noexcept { return {_mm_max_ps(a.v, b.v)}; }
+
+      /// Pick a where the mask is set, and b elsewhere                       
+      friend Float4 Select(Float4 mask, Float4 a, Float4 b) noexcept {
+         return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+      }
+   };
+
+   #if defined(__AVX__)
+      /// Eight floats, one for each ray of a packet                          
+      struct Float8 {
+         static constexpr Count Width = 8;
+         __m256 v;
+
+         static Float8 Set(float x) noexcept { return {_mm256_set1_ps(x)}; }
+         static Float8 Load(const float* p) noexcept { return {_mm256_loadu_ps(p)}; }
+         void Store(float* p) const noexcept { _mm256_storeu_ps(p, v); }
+         int Mask() const noexcept { return _mm256_movemask_ps(v); }
+
+         friend Float8 operator + (Float8 a, Float8 b) noexcept { return {_mm256_add_ps(a.v, b.v)}; }
+         friend Float8 operator - (Float8 a, Float8 b) noexcept { return {_mm256_sub_ps(a.v, b.v)}; }
+         friend Float8 operator * (Float8 a, Float8 b) noexcept { return {_mm256_mul_ps(a.v, b.v)}; }
+         friend Float8 operator / (Float8 a, Float8 b) noexcept { return {_mm256_div_ps(a.v, b.v)}; }
+         friend Float8 operator & (Float8 a, Float8 b) noexcept { return {_mm256_and_ps(a.v, b.v)}; }
+         friend Float8 operator <  (Float8 a, Float8 b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+         friend Float8 operator <= (Float8 a, Float8 b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+         friend Float8 operator >= (Float8 a, Float8 b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+         friend Float8 operator != (Float8 a, Float8 b) noexcept { return {_mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ)}; }
+         friend Float8 Min(Float8 a, Float8 b) noexcept { return {_mm256_min_ps(a.v, b.v)}; }
+         friend Float8 Max(Float8 a, Float8 b) noexcept { return {_mm256_max_ps(a.v, b.v)}; }
+
+         friend Float8 Select(Float8 mask, Float8 a, Float8 b) noexcept {
+            return {_mm256_blendv_ps(b.v, a.v, mask.v)};
+         }
+      };
+
+      using Packet = Float8;
+   #else
+      using Packet = Float4;
+   #endif
+
+   /// Rays of a packet, one for each lane                                    
+   struct Rays {
+      Packet mOrigin[3];
+      Packet mDirection[3];
+      Packet mInverse[3];
+   };
+
+   /// Intersect the rays of a packet with a node's box                       
+   ///   @param node - the node                                               
+   ///   @param rays - the rays                                               
+   ///   @param best - the closest hit of each ray so far                     
+   ///   @param near - [out] the distance each ray enters the box at          
+   ///   @return the mask of rays that enter the box before their closest     
+   ///      hit                                                               
+   inline Packet Slab(const BvhNode& node, const Rays& rays, Packet best, Packet& near) noexcept {
+      near = Packet::Set(0);
+      auto far = best;
+      for (int c = 0; c < 3; ++c) {
+         const auto t0 = (Packet::Set(node.mMin[c]) - rays.mOrigin[c]) * rays.mInverse[c];
+         const auto t1 = (Packet::Set(node.mMax[c]) - rays.mOrigin[c]) * rays.mInverse[c];
+         near = Max(near, Min(t0, t1));
+         far = Min(far, Max(t0, t1));
+      }
+      return near <= far;
+   }
+
+   /// Intersect the rays of a packet with a triangle, Moller-Trumbore style, 
+   /// one ray per lane. Same as the single ray test, but without branches    
+   ///   @param v - the three vertices of the triangle                        
+   ///   @param k - the triangle, in leaf order                               
+   ///   @param rays - the rays                                               
+   ///   @param best - [in/out] the closest hit of each ray                   
+   ///   @param u, w - [in/out] barycentric coordinates of each closest hit   
+   ///   @param triangles - [in/out] the triangle of each closest hit         
+   inline void Triangle(
+      const Vec3f* v, uint32_t k, const Rays& rays,
+      Packet& best, Packet& u, Packet& w, uint32_t* triangles
+   ) noexcept {
+      float e1[3], e2[3];
+      Sub(v[1], v[0], e1);
+      Sub(v[2], v[0], e2);
+      const Packet E1[3] {Packet::Set(e1[0]), Packet::Set(e1[1]), Packet::Set(e1[2])};
+      const Packet E2[3] {Packet::Set(e2[0]), Packet::Set(e2[1]), Packet::Set(e2[2])};
+
+      Packet p[3], s[3], q[3];
+      Cross(rays.mDirection, E2, p);
+      const auto det = Dot(E1, p);
+      const auto inverse = Packet::Set(1) / det;
+      for (int c = 0; c < 3; ++c)
+         s[c] = rays.mOrigin[c] - Packet::Set(v[0][c]);
+
+      const auto hitU = Dot(s, p) * inverse;
+      Cross(s, E1, q);
+      const auto hitW = Dot(rays.mDirection, q) * inverse;
+      const auto t = Dot(E2, q) * inverse;
+
+      const auto zero = Packet::Set(0);
+      const auto mask = (det != zero) & (hitU >= zero) & (hitW >= zero)
+         & (hitU + hitW <= Packet::Set(1)) & (t >= zero) & (t < best);
+      auto lanes = static_cast<unsigned>(mask.Mask());
+      if (not lanes)
+         return;
+
+      best = Select(mask, t, best);
+      u = Select(mask, hitU, u);
+      w = Select(mask, hitW, w);
+      while (lanes) {
+         triangles[::std::countr_zero(lanes)] = k;
+         lanes &= lanes - 1;
+      }
+   }
+
+   /// Find the closest triangle for a packet of rays, traversing the         
+   /// hierarchy once for all of them. Nodes are visited while any ray of     
+   /// the packet enters them, so coherent rays share most of the work        
+   ///   @param nodes - the hierarchy                                         
+   ///   @param triangles - the original triangle, in leaf order              
+   ///   @param vertices - triangle vertices, in leaf order                   
+   ///   @param batch - the rays                                              
+   ///   @param first - first ray of the packet in the batch                  
+   ///   @param hits - [out] the hits of the whole batch                      
+   ///   @return the number of rays in the packet that hit a triangle         
+   inline Count IntersectPacket(
+      const BvhNode* nodes, const uint32_t* triangles, const Vec3f* vertices,
+      const RayBatch& batch, Offset first, RayHit* hits
+   ) {
+      constexpr auto W = Packet::Width;
+      const auto lanes = ::std::min(W, batch.mCount - first);
+
+      // Rays missing from the last packet are copies of the first, that
+      // can't hit anything                                             
+      float origin[3][W], direction[3][W], inverse[3][W], maxDistance[W];
+      for (Offset lane = 0; lane < W; ++lane) {
+         const auto ray = first + (lane < lanes ? lane : 0);
+         for (int c = 0; c < 3; ++c) {
+            origin[c][lane] = batch.mOrigin[c][ray];
+            direction[c][lane] = batch.mDirection[c][ray];
+            inverse[c][lane] = direction[c][lane] != 0 ? 1 / direction[c][lane]
+               : ::std::copysign(FLT_MAX, direction[c][lane]);
+         }
+
+         maxDistance[lane] = lane >= lanes ? -1
+            : batch.mMaxDistance ? batch.mMaxDistance[ray] : FLT_MAX;
+      }
+
+      Rays rays;
+      for (int c = 0; c < 3; ++c) {
+         rays.mOrigin[c] = Packet::Load(origin[c]);
+         rays.mDirection[c] = Packet::Load(direction[c]);
+         rays.mInverse[c] = Packet::Load(inverse[c]);
+      }
+
+      auto best = Packet::Load(maxDistance);
+      auto u = Packet::Set(0);
+      auto w = Packet::Set(0);
+      uint32_t closest[W];
+      for (auto& k : closest)
+         k = RayHit::Miss;
+
+      uint32_t stack[StackSize];
+      Count top = 0;
+      stack[top++] = 0;
+
+      while (top) {
+         const auto& node = nodes[stack[--top]];
+         Packet near;
+         if (not Slab(node, rays, best, near).Mask())
+            continue;
+
+         if (node.mCount) {
+            for (auto k = node.mFirst; k < node.mFirst + node.mCount; ++k)
+               Triangle(vertices + k * 3, k, rays, best, u, w, closest);
+            continue;
+         }
+
+         // Visit the child that most rays enter first, by pushing it last
+         Packet nearLeft, nearRight;
+         const auto left = Slab(nodes[node.mFirst], rays, best, nearLeft).Mask();
+         const auto right = Slab(nodes[node.mFirst + 1], rays, best, nearRight).Mask();
+         const auto both = left & right;
+         const auto leftFirst = not both or 2 * ::std::popcount(
+            static_cast<unsigned>((nearLeft <= nearRight).Mask() & both)
+         ) >= ::std::popcount(static_cast<unsigned>(both));
+
+         if (leftFirst) {
+            if (right) stack[top++] = node.mFirst + 1;
+            if (left)  stack[top++] = node.mFirst;
+         }
+         else {
+            if (left)  stack[top++] = node.mFirst;
+            if (right) stack[top++] = node.mFirst + 1;
+         }
+      }
+
+      float distances[W], us[W], ws[W];
+      best.Store(distances);
+      u.Store(us);
+      w.Store(ws);
+
+      Count found = 0;
+      for (Offset lane = 0; lane < lanes; ++lane) {
+         auto& hit = hits[first + lane];
+         if (closest[lane] == RayHit::Miss) {
+            hit = {FLT_MAX, RayHit::Miss, 0, 0};
+            continue;
+         }
+
+         hit = {distances[lane], triangles[closest[lane]], us[lane], ws[lane]};
+         ++found;
+      }
+      return found;
+   }
+
+} // namespace Bvh
+#endif
+
+/// Find the closest triangle for each ray of a batch. Rays are traced in     
+/// packets of four, or eight if built with AVX, with a single traversal      
+/// and vectorized triangle tests for each packet. Where SSE isn't            
+/// available, rays are traced one by one                                     
+///   @param nodes - the hierarchy                                            
+///   @param triangles - the original triangle, in leaf order                 
+///   @param vertices - triangle vertices, in leaf order                      
+///   @param batch - the rays                                                 
+///   @param hits - [out] a hit for each ray                                  
+///   @return the number of rays that hit a triangle                          
+auto Bvh::Intersect(
+   const BvhNode* nodes, const uint32_t* triangles, const Vec3f* vertices,
+   const RayBatch& batch, RayHit* hits
+) -> Count {
+   Count found = 0;
+#if LANGULUS_BVH_SSE
+   for (Offset first = 0; first < batch.mCount; first += Packet::Width)
+      found += IntersectPacket(nodes, triangles, vertices, batch, first, hits);
+#else
+   for (Offset i = 0; i < batch.mCount; ++i) {
+      const Vec3f origin {batch.mOrigin[0][i], batch.mOrigin[1][i], batch.mOrigin[2][i]};
+      const Vec3f direction {batch.mDirection[0][i], batch.mDirection[1][i], batch.mDirection[2][i]};
+      const auto maxDistance = batch.mMaxDistance ? batch.mMaxDistance[i] : FLT_MAX;
+      hits[i] = {FLT_MAX, RayHit::Miss, 0, 0};
+      if (Intersect(nodes, triangles, vertices, origin, direction, maxDistance, hits[i]))
+         ++found;
+   }
+#endif
+   return found;
+}
@@ -0,0 +1,81 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include "Workers.hpp"
+
+
+///                                                                           
+///   A bounding volume hierarchy node                                        
+///                                                                           
+/// A binary tree of boxes over the triangles of a mesh, for ray and segment  
+/// queries, built with the binned surface area heuristic. It is built on     
+/// the first query, and committed as three data lists under Traits::Bvh:     
+///   0 - the nodes, with the root first. The children of an inner node are   
+///       always next to each other                                           
+///   1 - for each triangle in leaf order, the index of the original one      
+///   2 - for each triangle in leaf order, its three vertices, so that leaves 
+///       are intersected without going through the index buffer              
+///                                                                           
+struct BvhNode {
+   LANGULUS(NAME) "BvhNode";
+   LANGULUS(POD) true;
+
+   float mMin[3] {};
+   // Left child of an inner node, the right one follows it, or the     
+   // first triangle of a leaf                                          
+   uint32_t mFirst = 0;
+   float mMax[3] {};
+   // Triangles in a leaf, zero for inner nodes                         
+   uint32_t mCount = 0;
+};
+
+static_assert(sizeof(BvhNode) == 32, "Two nodes should fit a cache line");
+
+/// The closest intersection of a ray and a mesh                              
+struct RayHit {
+   // Triangle of rays that missed, in batched queries                  
+   static constexpr uint32_t Miss = ~uint32_t {0};
+
+   float    mDistance = 0;    // Along the ray, in units of its direction
+   uint32_t mTriangle = 0;    // Index of the triangle in the index buffer
+   float    mU = 0;           // Barycentric coordinates of the hit     
+   float    mV = 0;
+};
+
+/// A batch of rays, with a separate array for each coordinate, so that       
+/// they're loaded straight into vector registers                             
+struct RayBatch {
+   const float* mOrigin[3] {};
+   const float* mDirection[3] {};
+
+   // Hits further than this are ignored, in units of the direction,    
+   // optional                                                          
+   const float* mMaxDistance = nullptr;
+   Count mCount = 0;
+};
+
+namespace Bvh {
+
+   void Build(
+      const TMany<Vec3f>& positions, const TMany<uint32_t>& indices,
+      Workers&, TMany<BvhNode>& nodes, TMany<uint32_t>& triangles,
+      TMany<Vec3f>& vertices
+   );
+
+   bool Intersect(
+      const BvhNode*, const uint32_t* triangles, const Vec3f* vertices,
+      const Vec3f& origin, const Vec3f& direction, float maxDistance, RayHit&
+   );
+
+   auto Intersect(
+      const BvhNode*, const uint32_t* triangles, const Vec3f* vertices,
+      const RayBatch&, RayHit*
+   ) -> Count;
+
+} // namespace Bvh
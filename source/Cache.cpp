@@ -0,0 +1,317 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Mesh.hpp"
+#include <Langulus/IO.hpp>
+#include <Langulus/Flow/Time.hpp>
+#include <cstring>
+
+
+///                                                                           
+///   Binary mesh cache                                                       
+///                                                                           
+/// A versioned container with the committed data of a loaded mesh, written   
+/// next to the source file. It is a header, followed by each stream as a     
+/// raw array at an aligned offset, so loading it is a single read and a      
+/// bulk copy per stream, without any parsing                                 
+///                                                                           
+namespace MeshCache {
+
+   /// Change this whenever the layout below, or the data that is committed   
+   /// by the file readers changes, so that stale caches are rebuilt          
+   constexpr uint32_t Version = 6;
+   constexpr char Magic[4] {'L', 'M', 'S', 'H'};
+   constexpr uint64_t Alignment = 16;
+
+   /// Cached streams, in the order they're laid out in the file              
+   enum Stream : uint32_t {
+      Positions,
+      Normals,
+      TextureCoords,
+      Colors,
+      PositionIndices,           // Or the unified indices, if welded   
+      NormalIndices,
+      TextureIndices,
+      Bounds,                    // A single MeshBounds                 
+
+      StreamCount
+   };
+
+   /// Location of a stream inside the cache                                  
+   struct Entry {
+      uint64_t offset;           // Bytes from the start of the file    
+      uint64_t count;            // Number of elements                  
+      uint32_t stride;           // Bytes per element                   
+      uint32_t reserved;
+   };
+
+   /// Cache file header                                                      
+   struct Header {
+      char     magic[4];
+      uint32_t version;
+
+      // Size and hash of the source file, when the cache was made      
+      uint64_t source_size;
+      uint64_t source_hash;
+
+      // Mesh view, topology is always triangles for now                
+      uint32_t primitive_count;
+      uint32_t index_count;
+      uint32_t texture_mapping;
+      uint32_t bilateral;
+
+      // Load options the mesh was made with                            
+      uint32_t welded;
+      uint32_t optimized;
+
+      Entry    streams[StreamCount];
+   };
+
+   static_assert(::std::is_trivially_copyable_v<Header>);
+
+   uint64_t Hash(const Byte*, uint64_t);
+   bool Stamp(const A::File&, uint64_t& size, uint64_t& hash);
+
+   template<class T>
+   TMany<T> Load(const Bytes&, const Entry&);
+   Entry Plan(const Many*, uint64_t& offset);
+   void Store(Bytes&, const Many*, const Entry&);
+
+} // namespace MeshCache
+
+
+/// Hash the contents of a file, eight bytes at a time                        
+///   @param data - the bytes to hash                                         
+///   @param size - number of bytes                                           
+///   @return the hash                                                        
+uint64_t MeshCache::Hash(const Byte* data, uint64_t size) {
+   constexpr uint64_t K0 = 0x9E3779B97F4A7C15ull;
+   constexpr uint64_t K1 = 0xBF58476D1CE4E5B9ull;
+   uint64_t h = size * K0;
+
+   const auto mix = [&](uint64_t word) {
+      h ^= word * K0;
+      h = (h << 31) | (h >> 33);
+      h *= K1;
+   };
+
+   const auto words = size / 8;
+   for (uint64_t i = 0; i < words; ++i) {
+      uint64_t word;
+      ::std::memcpy(&word, data + i * 8, 8);
+      mix(word);
+   }
+
+   if (const auto tail = size % 8) {
+      uint64_t word = 0;
+      ::std::memcpy(&word, data + words * 8, tail);
+      mix(word);
+   }
+
+   h ^= h >> 29;
+   h *= K0;
+   return h ^ (h >> 32);
+}
+
+/// Identify the current contents of a source file. The file interface has    
+/// no notion of modification time, so the whole source is hashed, along      
+/// with its size - an edit anywhere in it, even one that keeps the size,     
+/// invalidates the cache. Hashing runs at memory speed, so it still costs    
+/// far less than parsing the source                                          
+///   @param file - the source file                                           
+///   @param size - [out] the size of the file                                
+///   @param hash - [out] the hash of the file                                
+///   @return false if the source file couldn't be read                       
+bool MeshCache::Stamp(const A::File& file, uint64_t& size, uint64_t& hash) {
+   if (not file.Exists())
+      return false;
+
+   const auto contents = file.ReadAs<Bytes>();
+   if (contents.IsEmpty())
+      return false;
+
+   size = contents.GetCount();
+   hash = Hash(contents.GetRaw(), size);
+   return true;
+}
+
+/// Copy a stream out of the cache                                            
+///   @param blob - the whole cache file                                      
+///   @param entry - the stream to copy                                       
+///   @return the stream contents                                             
+template<class T>
+TMany<T> MeshCache::Load(const Bytes& blob, const Entry& entry) {
+   TMany<T> result;
+   if (entry.count) {
+      result.template Reserve<true>(entry.count);
+      ::std::memcpy(static_cast<void*>(result.GetRaw()),
+         blob.GetRaw() + entry.offset, entry.count * sizeof(T));
+   }
+   return result;
+}
+
+/// Plan where a committed stream goes in the cache. Stream types are         
+/// validated when the cache is read back                                     
+///   @param data - the committed data, can be nullptr                        
+///   @param offset - [in/out] the end of the cache so far                    
+///   @return the stream entry                                                
+MeshCache::Entry MeshCache::Plan(const Many* data, uint64_t& offset) {
+   Entry entry {};
+   if (not data or data->IsEmpty())
+      return entry;
+
+   offset = (offset + Alignment - 1) & ~(Alignment - 1);
+   entry.offset = offset;
+   entry.count = data->GetCount();
+   entry.stride = static_cast<uint32_t>(data->GetStride());
+   offset += entry.count * entry.stride;
+   return entry;
+}
+
+/// Copy a committed stream into the cache                                    
+///   @param blob - [out] the whole cache file                                
+///   @param data - the committed data, can be nullptr                        
+///   @param entry - where the stream goes                                    
+void MeshCache::Store(Bytes& blob, const Many* data, const Entry& entry) {
+   if (entry.count)
+      ::std::memcpy(blob.GetRaw() + entry.offset, data->GetRaw(), entry.count * entry.stride);
+}
+
+/// Load the mesh from a binary cache, if it is up to date with its source    
+///   @param cache - the cache file                                           
+///   @param source - the file the cache was made from                        
+///   @return true if the mesh was loaded from the cache                      
+bool Mesh::ReadCache(const A::File& cache, const A::File& source) {
+   using namespace MeshCache;
+   if (not cache.Exists())
+      return false;
+
+   auto loadTime = SteadyClock::Now();
+   const auto blob = cache.ReadAs<Bytes>();
+   if (blob.GetCount() < sizeof(Header))
+      return false;
+
+   Header header;
+   ::std::memcpy(&header, blob.GetRaw(), sizeof(Header));
+   if (::std::memcmp(header.magic, Magic, sizeof(Magic))
+   or header.version != Version
+   or header.welded != (mWeld ? 1u : 0u)
+   or header.optimized != (mOptimize ? 1u : 0u))
+      return false;
+
+   // Make sure every stream is where the header says it is, and is of  
+   // the expected type. Welded indices can be 16 or 32 bits wide       
+   const auto& s = header.streams;
+   uint32_t strides[StreamCount] {
+      sizeof(Vec3f), sizeof(Vec3f), sizeof(Vec2f), sizeof(Vec3f),
+      sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t),
+      sizeof(MeshBounds)
+   };
+
+   if (header.welded and s[PositionIndices].stride == sizeof(uint16_t))
+      strides[PositionIndices] = sizeof(uint16_t);
+
+   for (uint32_t i = 0; i < StreamCount; ++i) {
+      const auto& entry = s[i];
+      if (not entry.count)
+         continue;
+
+      if (entry.stride != strides[i]
+      or entry.offset > blob.GetCount()
+      or entry.count > (blob.GetCount() - entry.offset) / entry.stride)
+         return false;
+   }
+
+   // Rebuild the cache if source has changed since it was made         
+   uint64_t size, hash;
+   if (not Stamp(source, size, hash)
+   or size != header.source_size or hash != header.source_hash)
+      return false;
+
+   mView.mPrimitiveCount = header.primitive_count;
+   mView.mIndexCount = header.index_count;
+   mView.mTextureMapping = static_cast<Math::MapModeType>(header.texture_mapping);
+   mView.mBilateral = header.bilateral != 0;
+   mView.mTopology = MetaDataOf<A::Triangle>();
+
+   Commit<Traits::Place>   (Load<Vec3f>(blob, s[Positions]));
+   Commit<Traits::Aim>     (Load<Vec3f>(blob, s[Normals]));
+   Commit<Traits::Sampler> (Load<Vec2f>(blob, s[TextureCoords]));
+   Commit<Traits::Color>   (Load<Vec3f>(blob, s[Colors]));
+
+   if (header.welded) {
+      if (strides[PositionIndices] == sizeof(uint16_t))
+         Commit<Traits::Index>(Load<uint16_t>(blob, s[PositionIndices]));
+      else
+         Commit<Traits::Index>(Load<uint32_t>(blob, s[PositionIndices]));
+   }
+   else {
+      Commit<Traits::Index>(Traits::Place   {Load<uint32_t>(blob, s[PositionIndices])});
+      Commit<Traits::Index>(Traits::Aim     {Load<uint32_t>(blob, s[NormalIndices])});
+      Commit<Traits::Index>(Traits::Sampler {Load<uint32_t>(blob, s[TextureIndices])});
+   }
+
+   // Empty bounds would never be computed, so they're committed only   
+   // if they were cached                                               
+   if (s[Bounds].count)
+      Commit<Traits::Bounds>(Load<MeshBounds>(blob, s[Bounds]));
+
+   Logger::Verbose(Logger::Green, "File ", source.GetFilePath(),
+      " loaded from cache in ", SteadyClock::Now() - loadTime);
+   return true;
+}
+
+/// Save the committed mesh data to a binary cache. Failing to write the      
+/// cache isn't an error - the asset folder might be read-only                
+///   @param cache - the cache file                                           
+///   @param source - the file the mesh was loaded from                       
+void Mesh::WriteCache(const A::File& cache, const A::File& source) const {
+   using namespace MeshCache;
+
+   try {
+      Header header {};
+      ::std::memcpy(header.magic, Magic, sizeof(Magic));
+      header.version = Version;
+      if (not Stamp(source, header.source_size, header.source_hash))
+         return;
+
+      header.primitive_count = mView.mPrimitiveCount;
+      header.index_count = mView.mIndexCount;
+      header.texture_mapping = static_cast<uint32_t>(mView.mTextureMapping);
+      header.bilateral = mView.mBilateral ? 1 : 0;
+      header.welded = mWeld ? 1 : 0;
+      header.optimized = mOptimize ? 1 : 0;
+
+      const Many* data[StreamCount] {
+         GetData<Traits::Place>(),
+         GetData<Traits::Aim>(),
+         GetData<Traits::Sampler>(),
+         GetData<Traits::Color>(),
+         GetData<Traits::Index>(0),
+         GetData<Traits::Index>(1),
+         GetData<Traits::Index>(2),
+         GetData<Traits::Bounds>()
+      };
+
+      auto& s = header.streams;
+      uint64_t size = sizeof(Header);
+      for (uint32_t i = 0; i < StreamCount; ++i)
+         s[i] = Plan(data[i], size);
+
+      Bytes blob;
+      blob.Reserve<true>(size);
+      ::std::memset(blob.GetRaw(), 0, size);
+      ::std::memcpy(blob.GetRaw(), &header, sizeof(Header));
+      for (uint32_t i = 0; i < StreamCount; ++i)
+         Store(blob, data[i], s[i]);
+
+      cache.NewWriter(false)->Write(blob);
+   }
+   catch (...) {
+      Logger::Warning(Self(), "Couldn't write mesh cache ", cache.GetFilePath());
+   }
+}
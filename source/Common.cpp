@@ -8,6 +8,10 @@
 #include "Common.hpp"
 #include <Langulus/Math/Primitives.hpp>
 #include "generators/Grid.hpp"
+#include "Meshlets.hpp"
+#include "Interleave.hpp"
+#include "Bounds.hpp"
+#include "Bvh.hpp"
 
 
 /// Register meshes                                                           
@@ -16,4 +20,8 @@ void RegisterMeshes() {
 
    (void) MetaOf<Grid2>();
    (void) MetaOf<Grid3>();
+   (void) MetaOf<Meshlet>();
+   (void) MetaOf<VertexLayout>();
+   (void) MetaOf<MeshBounds>();
+   (void) MetaOf<BvhNode>();
 }
\ No newline at end of file
@@ -15,6 +15,18 @@ struct MeshLibrary;
 struct Mesh;
 
 LANGULUS_DEFINE_TRAIT(Tesselation, "Tesselation level, usually an integer");
+LANGULUS_DEFINE_TRAIT(Weld, "Whether to unify vertex attributes under a single index buffer, usually a boolean");
+LANGULUS_DEFINE_TRAIT(Meshlets, "Triangle clusters with bounding spheres and normal cones");
+LANGULUS_DEFINE_TRAIT(Simplify, "Level of simplification, where each level halves the triangles, usually an integer");
+LANGULUS_DEFINE_TRAIT(Optimize, "Whether to reorder triangles and vertices for GPU cache efficiency, usually a boolean");
+LANGULUS_DEFINE_TRAIT(Interleave, "Whether to also make a single interleaved vertex buffer, usually a boolean");
+LANGULUS_DEFINE_TRAIT(Bounds, "Bounding box, bounding sphere and surface area of a mesh");
+LANGULUS_DEFINE_TRAIT(Bvh, "Bounding volume hierarchy over the triangles of a mesh, for ray queries");
+LANGULUS_DEFINE_TRAIT(Quantize, "Compact encodings of the interleaved vertex attributes, usually an integer of VertexLayout::Quantization bits");
+LANGULUS_DEFINE_TRAIT(Async, "Whether a file-based mesh is loaded in the background, usually a boolean");
+LANGULUS_DEFINE_TRAIT(Progressive, "Publish the geometry of a file while it's loading, every given number of megabytes, usually an integer");
+LANGULUS_DEFINE_TRAIT(Budget, "Memory budget in bytes, for data that can be regenerated, usually an integer");
+LANGULUS_DEFINE_TRAIT(Evictable, "Whether the generated data of a mesh can be released to fit the memory budget, and generated again when needed - readers must pin such meshes, usually a boolean");
 
 #if 0
    #define VERBOSE_MESHES(...)      Logger::Verbose(Self(), __VA_ARGS__)
@@ -24,4 +36,10 @@ LANGULUS_DEFINE_TRAIT(Tesselation, "Tesselation level, usually an integer");
    #define VERBOSE_MESHES_TAB(...)  LANGULUS(NOOP)
 #endif
 
-void RegisterMeshes();
\ No newline at end of file
+void RegisterMeshes();
+
+/// A list of types, for compile-time iteration                               
+template<class...T>
+struct TypeList {
+   static constexpr Count Size = sizeof...(T);
+};
\ No newline at end of file
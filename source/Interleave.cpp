@@ -0,0 +1,201 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Interleave.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <cstring>
+
+
+namespace Encode {
+
+   /// Bytes of each encoding, zero for raw attributes                        
+   constexpr uint32_t Sizes[] {0, 6, 4, 2, 4};
+
+   /// Convert a float to a half-precision float, rounding to nearest         
+   ///   @param value - the float to convert                                  
+   ///   @return the bits of the half-precision float                         
+   inline uint16_t Half(float value) noexcept {
+      uint32_t bits;
+      ::std::memcpy(&bits, &value, sizeof(bits));
+      const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+      const auto exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+      auto mantissa = bits & 0x7FFFFF;
+
+      if (exponent >= 31) {
+         // Overflow becomes infinity, NaN stays NaN                    
+         const bool nan = ((bits >> 23) & 0xFF) == 0xFF and mantissa;
+         return sign | 0x7C00 | (nan ? 0x200 : 0);
+      }
+
+      if (exponent <= 0) {
+         // Too small for a normal half, so make a subnormal one        
+         if (exponent < -10)
+            return sign;
+
+         mantissa |= 0x800000;
+         const auto shift = static_cast<uint32_t>(14 - exponent);
+         const auto half = mantissa >> shift;
+         const auto round = (mantissa >> (shift - 1)) & 1;
+         return static_cast<uint16_t>(sign | (half + round));
+      }
+
+      // Rounding may carry into the exponent, which is still correct   
+      const auto half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+      return static_cast<uint16_t>(sign | (half + ((mantissa >> 12) & 1)));
+   }
+
+   /// Map a unit vector onto the octahedron, unfolded onto a square          
+   ///   @param n - the unit vector                                           
+   ///   @param out - [out] the two coordinates in the [-1;1] range           
+   inline void Octahedral(const float (&n)[3], float (&out)[2]) noexcept {
+      const auto l1 = ::std::abs(n[0]) + ::std::abs(n[1]) + ::std::abs(n[2]);
+      if (l1 <= 0) {
+         out[0] = out[1] = 0;
+         return;
+      }
+
+      const auto x = n[0] / l1;
+      const auto y = n[1] / l1;
+      if (n[2] >= 0) {
+         out[0] = x;
+         out[1] = y;
+      }
+      else {
+         // Fold the lower hemisphere over the diagonals                
+         out[0] = (1 - ::std::abs(y)) * (x >= 0 ? 1.f : -1.f);
+         out[1] = (1 - ::std::abs(x)) * (y >= 0 ? 1.f : -1.f);
+      }
+   }
+
+   /// Convert to a signed normalized integer                                 
+   ///   @param value - the value in the [-1;1] range                         
+   ///   @return the integer                                                  
+   template<class T>
+   T Snorm(float value) noexcept {
+      constexpr float max = static_cast<float>(::std::numeric_limits<T>::max());
+      return static_cast<T>(::std::lround(::std::clamp(value, -1.f, 1.f) * max));
+   }
+
+} // namespace Encode
+
+
+/// Lay attributes out one after another, each aligned to four bytes, which   
+/// is what vertex fetch requires for the usual float formats                 
+///   @param sizes - bytes of each attribute, zero if absent                  
+///   @param quantize - Quantization bits, for attributes that are encoded    
+///      instead of copied. Only single-precision vectors can be encoded      
+///   @return the layout                                                      
+auto VertexLayout::Describe(
+   const Count (&sizes)[AttributeCount], uint32_t quantize
+) -> VertexLayout {
+   VertexLayout layout;
+   if (quantize & QuantizePositions and sizes[Position] == sizeof(Vec3f))
+      layout.mEncodings[Position] = Unorm16;
+
+   if (sizes[Normal] == sizeof(Vec3f)) {
+      if (quantize & QuantizeNormals8)
+         layout.mEncodings[Normal] = Octahedral8;
+      else if (quantize & QuantizeNormals)
+         layout.mEncodings[Normal] = Octahedral16;
+   }
+
+   if (quantize & QuantizeSamplers and sizes[Sampler] == sizeof(Vec2f))
+      layout.mEncodings[Sampler] = Half2;
+
+   for (uint32_t a = 0; a < AttributeCount; ++a) {
+      if (not sizes[a])
+         continue;
+
+      layout.mOffsets[a] = layout.mStride;
+      layout.mSizes[a] = layout.mEncodings[a] == Raw
+         ? static_cast<uint32_t>(sizes[a])
+         : Encode::Sizes[layout.mEncodings[a]];
+      layout.mStride += (layout.mSizes[a] + 3) & ~3u;
+   }
+   return layout;
+}
+
+/// Fit quantized positions to the bounds of the given ones, so that the      
+/// whole 16-bit range is used. Must be done before writing any vertex        
+///   @param positions - the positions, as an array of Vec3f                  
+///   @param count - number of positions                                      
+void VertexLayout::Bound(const Byte* positions, Count count) {
+   if (not count)
+      return;
+
+   float min[3] {FLT_MAX, FLT_MAX, FLT_MAX};
+   float max[3] {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+   for (Offset i = 0; i < count; ++i) {
+      float p[3];
+      ::std::memcpy(p, positions + i * sizeof(Vec3f), sizeof(p));
+      for (int c = 0; c < 3; ++c) {
+         min[c] = ::std::min(min[c], p[c]);
+         max[c] = ::std::max(max[c], p[c]);
+      }
+   }
+
+   for (int c = 0; c < 3; ++c) {
+      mOrigin[c] = min[c];
+      mScale[c] = (max[c] - min[c]) / 65535.f;
+   }
+}
+
+/// Copy or encode an attribute of a vertex into the buffer                   
+///   @param vertex - start of the vertex in the buffer                       
+///   @param attribute - the attribute to write                               
+///   @param element - the attribute value, as in its separate stream         
+void VertexLayout::Write(Byte* vertex, Attribute attribute, const void* element) const {
+   if (mOffsets[attribute] == Absent)
+      return;
+
+   const auto to = vertex + mOffsets[attribute];
+   const auto encoding = mEncodings[attribute];
+   if (encoding == Raw) {
+      ::std::memcpy(to, element, mSizes[attribute]);
+      return;
+   }
+
+   float v[3] {};
+   ::std::memcpy(v, element, (encoding == Half2 ? 2 : 3) * sizeof(float));
+
+   switch (encoding) {
+   case Unorm16: {
+      uint16_t q[3] {};
+      for (int c = 0; c < 3; ++c) {
+         if (mScale[c] > 0) {
+            const auto n = (v[c] - mOrigin[c]) / mScale[c];
+            q[c] = static_cast<uint16_t>(::std::clamp(n + .5f, 0.f, 65535.f));
+         }
+      }
+      ::std::memcpy(to, q, sizeof(q));
+      break;
+   }
+   case Octahedral16: case Octahedral8: {
+      float o[2];
+      Encode::Octahedral(v, o);
+      if (encoding == Octahedral16) {
+         const int16_t q[2] {Encode::Snorm<int16_t>(o[0]), Encode::Snorm<int16_t>(o[1])};
+         ::std::memcpy(to, q, sizeof(q));
+      }
+      else {
+         const int8_t q[2] {Encode::Snorm<int8_t>(o[0]), Encode::Snorm<int8_t>(o[1])};
+         ::std::memcpy(to, q, sizeof(q));
+      }
+      break;
+   }
+   case Half2: {
+      const uint16_t h[2] {Encode::Half(v[0]), Encode::Half(v[1])};
+      ::std::memcpy(to, h, sizeof(h));
+      break;
+   }
+   default:
+      break;
+   }
+}
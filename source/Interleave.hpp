@@ -0,0 +1,78 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+
+
+///                                                                           
+///   Interleaved vertex layout                                               
+///                                                                           
+/// Describes a GPU-ready vertex buffer, where all attributes of a vertex     
+/// are next to each other, so that it can be uploaded with a single copy.    
+/// Interleaved vertices are committed as two data lists under                
+/// Traits::Interleave, next to the separate attribute streams:               
+///   0 - the vertex buffer, as raw bytes                                     
+///   1 - a single VertexLayout, describing the buffer                        
+/// Each attribute keeps the element type of its separate stream, so that     
+/// Traits::Place for example tells the format of the position attribute,     
+/// unless the layout says it is quantized - see Traits::Quantize             
+///                                                                           
+struct VertexLayout {
+   LANGULUS(NAME) "VertexLayout";
+   LANGULUS(POD) true;
+
+   /// Attributes, in the order they're laid out in a vertex                  
+   enum Attribute : uint32_t {
+      Position,
+      Normal,
+      Sampler,
+      Color,
+
+      AttributeCount
+   };
+
+   /// How an attribute is encoded in the buffer                              
+   enum Encoding : uint32_t {
+      // Same as the element of the separate stream                     
+      Raw,
+      // Three 16-bit unsigned normalized integers, decoded as          
+      // mOrigin + value * mScale                                       
+      Unorm16,
+      // Octahedral unit vector, as two 16-bit signed normalized ints   
+      Octahedral16,
+      // Octahedral unit vector, as two 8-bit signed normalized ints    
+      Octahedral8,
+      // Two half-precision floats                                      
+      Half2
+   };
+
+   /// Bits of Traits::Quantize, selecting which attributes are encoded       
+   enum Quantization : uint32_t {
+      QuantizePositions = 1,     // Positions as Unorm16                
+      QuantizeNormals = 2,       // Normals as Octahedral16             
+      QuantizeNormals8 = 4,      // Normals as Octahedral8              
+      QuantizeSamplers = 8       // Texture coordinates as Half2        
+   };
+
+   // Offset of attributes that aren't in the buffer                    
+   static constexpr uint32_t Absent = ~uint32_t {0};
+
+   uint32_t mStride = 0;         // Bytes per vertex                    
+   uint32_t mOffsets[AttributeCount] {Absent, Absent, Absent, Absent};
+   uint32_t mSizes[AttributeCount] {};
+   Encoding mEncodings[AttributeCount] {};
+
+   // Bounds of the positions, used to decode Unorm16 positions         
+   float mOrigin[3] {};
+   float mScale[3] {};
+
+   static auto Describe(const Count (&sizes)[AttributeCount], uint32_t quantize = 0) -> VertexLayout;
+
+   void Bound(const Byte* positions, Count count);
+   void Write(Byte* vertex, Attribute attribute, const void* element) const;
+};
@@ -7,6 +7,8 @@
 ///                                                                           
 #include "Mesh.hpp"
 #include "MeshLibrary.hpp"
+#include "OBJ.hpp"
+#include "Weld.hpp"
 
 #include "generators/Box.inl"
 #include "generators/Cylinder.inl"
@@ -20,6 +22,60 @@
 #include "generators/Zode.inl"
 
 #include <Langulus/IO.hpp>
+#include <Langulus/Flow/Time.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+
+///                                                                           
+///   Generator registry                                                      
+///                                                                           
+/// Each registered primitive maps to its generator, instantiated for every   
+/// topology that generator implements. The first registered topology is      
+/// used when a descriptor doesn't specify any. Topologies that would hit a   
+/// static_assert in the generator are left out                               
+///                                                                           
+
+/// Topologies are matched in this order - strips come first, because they    
+/// are also triangles/lines                                                  
+constexpr Offset TopologyCount = 5;
+
+/// Get the generator slot of a topology type                                 
+template<class T>
+consteval Offset TopologySlot() {
+   if constexpr (CT::Exact<T, A::TriangleStrip>)   return 0;
+   else if constexpr (CT::Exact<T, A::Triangle>)   return 1;
+   else if constexpr (CT::Exact<T, A::LineStrip>)  return 2;
+   else if constexpr (CT::Exact<T, A::Line>)       return 3;
+   else if constexpr (CT::Exact<T, A::Point>)      return 4;
+   else static_assert(false, "Unsupported topology");
+}
+
+/// Get the generator slot of a topology                                      
+///   @param topology - the topology type                                     
+///   @return the slot, or TopologyCount if topology isn't supported          
+Offset TopologySlot(DMeta topology) {
+   if (topology->CastsTo<A::TriangleStrip>())
+      return TopologySlot<A::TriangleStrip>();
+   else if (topology->CastsTo<A::Triangle>())
+      return TopologySlot<A::Triangle>();
+   else if (topology->CastsTo<A::LineStrip>())
+      return TopologySlot<A::LineStrip>();
+   else if (topology->CastsTo<A::Line>())
+      return TopologySlot<A::Line>();
+   else if (topology->CastsTo<A::Point>())
+      return TopologySlot<A::Point>();
+   else
+      return TopologyCount;
+}
+
+/// Generator functions of a primitive, one for each topology slot            
+struct Mesh::GeneratorSet {
+   bool (*mDefault[TopologyCount])(Construct&) {};
+   void (Mesh::*mFill[TopologyCount])() {};
+   Offset mFallback = TopologyCount;
+};
 
 
 /// Mesh construction                                                         
@@ -30,6 +86,13 @@ Mesh::Mesh(MeshLibrary* producer, const Many& desc)
    , ProducedFrom {producer, desc} {
    // Get a path from the descriptor                                    
    VERBOSE_MESHES("Initializing...");
+   desc.ExtractTrait<Traits::Interleave>(mInterleave);
+
+   // Quantized attributes live only in the interleaved vertex buffer,  
+   // while separate streams stay in full precision for processing      
+   desc.ExtractTrait<Traits::Quantize>(mQuantize);
+   if (mQuantize)
+      mInterleave = true;
 
    if (not FromFile(desc)) {
       // Mesh isn't file-based, so inspect the descriptor more closely  
@@ -45,15 +108,81 @@ Mesh::Mesh(MeshLibrary* producer, const Many& desc)
             Mesh, "Couldn't create mesh generator");
          LANGULUS_ASSERT(mGenerators,
             Mesh, "No generators found in mesh");
+
+         // Generated data can be evicted, and made again when needed,  
+         // but only if asked for, since readers must pin the mesh      
+         desc.ExtractTrait<Traits::Evictable>(mEvictable);
+         producer->Track(this);
       }
    }
 
+   // Meshlets can be built for any mesh that has indices and positions 
+   mGenerators.Insert(MetaOf<Traits::Meshlets>(), GenerateMeshlets);
+   mDependencies.Insert(MetaOf<Traits::Meshlets>(), TMany<TMeta> {
+      MetaOf<Traits::Index>(), MetaOf<Traits::Place>()
+   });
+
+   // So can the bounding volume hierarchy, on the first ray query      
+   mGenerators.Insert(MetaOf<Traits::Bvh>(), GenerateBvh);
+   mDependencies.Insert(MetaOf<Traits::Bvh>(), TMany<TMeta> {
+      MetaOf<Traits::Index>(), MetaOf<Traits::Place>()
+   });
+
+   // Interleaved vertices are packed from the vertex streams on demand,
+   // unless they were written while loading the file. Streams without  
+   // a generator, like loaded colors, are packed as they are           
+   if (mInterleave) {
+      TMany<TMeta> streams;
+      for (auto trait : {
+         MetaOf<Traits::Place>(), MetaOf<Traits::Aim>(),
+         MetaOf<Traits::Sampler>(), MetaOf<Traits::Color>()
+      }) {
+         if (mGenerators.FindIt(trait))
+            streams << trait;
+      }
+
+      mGenerators.Insert(MetaOf<Traits::Interleave>(), GenerateInterleaved);
+      mDependencies.Insert(MetaOf<Traits::Interleave>(), Abandon(streams));
+   }
+
+   // Bounds are computed from positions on demand, unless they were    
+   // committed with the positions                                      
+   TMany<TMeta> bounded;
+   for (auto trait : {MetaOf<Traits::Place>(), MetaOf<Traits::Index>()}) {
+      if (mGenerators.FindIt(trait))
+         bounded << trait;
+   }
+
+   mGenerators.Insert(MetaOf<Traits::Bounds>(), GenerateBounds);
+   mDependencies.Insert(MetaOf<Traits::Bounds>(), Abandon(bounded));
+   ReserveDataLists();
+
    // If this was reached, then mesh was successfully initialized, so   
    // it is ready to be added to the hierarchy of Things                
    Couple(desc);
+
+   // A file is loaded in the background only now, that the mesh is set 
+   // up, because the loader writes to its view and data lists          
+   if (mLoader) {
+      GetLibrary()->GetWorkers().Push(::std::move(mLoader));
+
+      // Files requested in a batch are waited for at its end           
+      bool async = false;
+      desc.ExtractTrait<Traits::Async>(async);
+      if (not async)
+         *GetLibrary()->GetBatch() << this;
+   }
+
    VERBOSE_MESHES("Initialized");
 }
 
+/// Mesh destruction, waits for the background loading to finish, if any      
+Mesh::~Mesh() {
+   Wait();
+   if (mPrimitive)
+      GetLibrary()->Untrack(this);
+}
+
 /// React on environmental change                                             
 /*void Mesh::Teardown() {
    mGenerators.Reset();
@@ -71,28 +200,679 @@ void Mesh::Create(Verb&) {
    TODO();
 }
 
-/// Generate data                                                             
-///   @param trait - the trait to generate                                    
+/// A generator, that runs in a wave of Mesh::GenerateAll on this thread      
+struct WaveGenerator {
+   const Mesh* mMesh;
+   // Set, if the generator asked for data that isn't committed yet     
+   bool* mDeferred;
+};
+
+static thread_local WaveGenerator* Waving = nullptr;
+
+/// Generate data. Safe to call from many threads at once - each trait is     
+/// generated only once, and callers that arrive in the meantime wait for     
+/// it, instead of generating it again. Once generated, data is found         
+/// without any locking. Generated data of evictable meshes can be evicted    
+/// at any time, so callers that read it afterwards must pin the mesh before  
+/// generating, and keep it pinned while reading - see Mesh::Pin              
+///   @param trait - the trait to generate, or none to generate all missing   
+///      data lists at once - see Mesh::GenerateAll                           
 ///   @param index - trait group to generate                                  
 ///   @return true if data was generated                                      
 bool Mesh::Generate(TMeta trait, Offset index) {
-   auto foundData = GetDataListMap().FindIt(trait);
-   if (foundData) {
-      if (foundData.GetValue().GetCount() > index)
+   if (not trait) {
+      GenerateAll();
+      return IsReady();
+   }
+
+   // Data of a mesh that is still loading isn't ready yet              
+   if (not IsReady())
+      return false;
+
+   if (mPrimitive)
+      mLastUse = GetLibrary()->NextUse();
+
+   // Sequentially consistent, so that eviction never misses a reader   
+   // that is about to use the data - see Mesh::Evict                   
+   const auto slot = GetGeneratedSlot(trait);
+   if (slot < GeneratedSlots and index < mGenerated[slot].load())
+      return true;
+
+   if (Waving and Waving->mMesh == this) {
+      // A generator in a wave of GenerateAll, whose caller holds the   
+      // lock while waiting for the wave. Nothing is committed during a 
+      // wave, so the data of earlier waves is safe to look for. Data   
+      // that isn't there yet can't be made now, so the generator is    
+      // run again after the wave, when it can                          
+      if (CountData(trait) > index)
          return true;
+      if (mGenerators.FindIt(trait))
+         *Waving->mDeferred = true;
+      return false;
    }
 
-   auto foundGen = mGenerators.FindIt(trait);
-   if (foundGen) {
-      foundGen.GetValue()(this);
-      foundData = GetDataListMap().FindIt(trait);
-      if (foundData) {
-         if (foundData.GetValue().GetCount() > index)
-            return true;
+   // Generators commit to the data list map, so they run one at a time 
+   // Generators can generate the data they depend on, hence recursive  
+   ::std::lock_guard lock {mGenerateMutex};
+   if (CountData(trait) <= index) {
+      auto foundGen = mGenerators.FindIt(trait);
+      if (foundGen)
+         RunGenerator(trait, foundGen.GetValue());
+   }
+
+   PublishGenerated();
+   return CountData(trait) > index;
+}
+
+/// Data lists that generators commit to, that can be evicted and generated   
+/// again when memory is low                                                  
+using EvictableStreams = TypeList<
+   Traits::Index, Traits::Place, Traits::Aim, Traits::Sampler, Traits::Color,
+   Traits::Meshlets, Traits::Interleave, Traits::Bounds, Traits::Bvh
+>;
+
+/// Call a function template for each trait in a list of data lists           
+///   @tparam LIST - the list of traits                                       
+///   @param call - the function, called with the trait as template argument, 
+///      and the trait's index in LIST as argument                            
+template<class LIST, class F>
+void ForEachStream(F&& call) {
+   [&]<class...T>(TypeList<T...>) {
+      Offset s = 0;
+      (call.template operator()<T>(s++), ...);
+   }(LIST {});
+}
+
+/// Get the slot, where the number of generated groups of a trait is          
+/// published                                                                 
+///   @param trait - the data list                                            
+///   @return the slot, or GeneratedSlots if it's not a generated list        
+auto Mesh::GetGeneratedSlot(TMeta trait) -> Offset {
+   Offset result = GeneratedSlots;
+   ForEachStream<EvictableStreams>([&]<class T>(Offset s) {
+      if (trait == MetaOf<T>())
+         result = s;
+   });
+   return result;
+}
+
+/// Publish the number of groups of all generated data lists, after they      
+/// were committed, so that other threads find them without locking. The      
+/// data generated for a trait is never modified afterwards, until evicted    
+void Mesh::PublishGenerated() {
+   static_assert(EvictableStreams::Size == GeneratedSlots,
+      "Generated data lists and their published counts don't match");
+
+   ForEachStream<EvictableStreams>([&]<class T>(Offset s) {
+      mGenerated[s].store(CountData(MetaOf<T>()), ::std::memory_order_release);
+   });
+}
+
+/// Count the groups of a data list                                           
+///   @param trait - the data list                                            
+///   @return the number of groups, zero if there's no such data              
+auto Mesh::CountData(TMeta trait) const -> Count {
+   const auto found = GetDataListMap().FindIt(trait);
+   return found ? found.GetValue().GetCount() : 0;
+}
+
+/// Most groups a generated data list is committed as - indices that are      
+/// separate for each attribute, meshlets and hierarchies have three          
+constexpr Count DataListGroups = 4;
+
+/// Make sure every data list that can be generated is in the data list map,  
+/// with room for all of its groups. Data is found without locking once it's  
+/// published, so committing other data later must never move the map, or a   
+/// list in it - see Mesh::Generate                                           
+void Mesh::ReserveDataLists() {
+   ForEachStream<EvictableStreams>([&]<class T>(Offset) {
+      if (not mDataListMap.FindIt(MetaOf<T>()))
+         mDataListMap.Insert(MetaOf<T>(), DataList {});
+      mDataListMap.FindIt(MetaOf<T>()).GetValue().Reserve(DataListGroups);
+   });
+}
+
+/// Data lists committed by the generators running on this thread, if they    
+/// are collected instead of committed                                        
+static thread_local StreamCache::Streams* Staging = nullptr;
+
+/// Check if data committed on this thread is collected instead               
+///   @return true if committing is deferred                                  
+bool Mesh::IsStaging() {
+   return Staging != nullptr;
+}
+
+/// Collect a data list, instead of committing it                             
+///   @param trait - the data list                                            
+///   @param commit - commits the data to a mesh, once it's safe to do so     
+///   @param data - the data to collect                                       
+void Mesh::StageData(TMeta trait, FCommit commit, Many&& data) {
+   *Staging << StreamCache::Stream {trait, commit, Move(data)};
+}
+
+/// Run a generator, or reuse the data it has already made for an identical   
+/// mesh, without committing anything. Generators read only data that was     
+/// committed before, so this can run concurrently for different traits.      
+/// A generator might commit to other traits than the one it is registered    
+/// for - materials are committed as colors for example - so all data lists   
+/// it commits are collected                                                  
+///   @param trait - the trait to generate                                    
+///   @param generator - the generator function                               
+///   @param shared - [out] whether the data came from the library            
+///   @return the data lists, in the order the generator committed them       
+auto Mesh::Prepare(TMeta trait, FGenerator generator, bool& shared) -> StreamCache::Streams {
+   StreamCache::Streams streams;
+   shared = mShareStreams and GetLibrary()->GetStreams()
+      .Find(GetStreamKey(trait, generator), streams);
+   if (shared)
+      return streams;
+
+   const auto previous = Staging;
+   Staging = &streams;
+   try { generator(this); }
+   catch (...) {
+      Staging = previous;
+      throw;
+   }
+
+   Staging = previous;
+   return streams;
+}
+
+/// Commit the data lists of a generator. Freshly generated data is           
+/// optimized, and then shared with identical meshes                          
+///   @param trait - the generated trait                                      
+///   @param generator - the generator function                               
+///   @param streams - the data lists, as returned by Prepare                 
+///   @param shared - whether the data came from the library                  
+void Mesh::Adopt(TMeta trait, FGenerator generator, StreamCache::Streams& streams, bool shared) {
+   // Indices might be committed along with other data, like positions  
+   bool indexed = false;
+   for (auto& stream : streams)
+      indexed |= stream.mTrait == MetaOf<Traits::Index>();
+
+   // Indices that are already published are never modified, so only    
+   // the first indices committed are optimized                         
+   const auto firstIndex = CountData(MetaOf<Traits::Index>());
+   const auto optimize = not shared and mOptimize and indexed and not firstIndex;
+
+   for (auto& stream : streams)
+      stream.mCommit(this, stream.mData);
+
+   if (shared)
+      return;
+
+   if (optimize) {
+      // Other streams might be generated later, so only the order of   
+      // triangles can change here. Optimizing replaces the committed   
+      // indices, so the replacements are the ones to share             
+      Optimize(false);
+
+      Offset group = firstIndex;
+      for (auto& stream : streams) {
+         if (stream.mTrait == MetaOf<Traits::Index>())
+            stream.mData = *GetData<Traits::Index>(group++);
       }
    }
 
-   return false;
+   if (mShareStreams)
+      GetLibrary()->GetStreams().Insert(GetStreamKey(trait, generator), streams);
+}
+
+/// Get everything the data of a generator depends on                         
+///   @param trait - the trait to generate                                    
+///   @param generator - the generator function                               
+///   @return the key, for sharing the data with identical meshes             
+auto Mesh::GetStreamKey(TMeta trait, FGenerator generator) const -> StreamCache::Key {
+   unsigned tesselation = 0;
+   GetDescriptor().ExtractTrait<Traits::Tesselation>(tesselation);
+   return {
+      generator, mPrimitive, mView.mTopology, trait, tesselation,
+      static_cast<uint32_t>(mView.mTextureMapping), mOptimize
+   };
+}
+
+/// Run a generator, or reuse the data it has already made for an identical   
+/// mesh                                                                      
+///   @param trait - the trait to generate                                    
+///   @param generator - the generator function                               
+void Mesh::RunGenerator(TMeta trait, FGenerator generator) {
+   bool shared;
+   auto streams = Prepare(trait, generator, shared);
+   Adopt(trait, generator, streams, shared);
+}
+
+/// Generate all missing data lists at once, running the generators           
+/// concurrently on the library's workers. Generators that read the data      
+/// of other generators run after them, in waves, so this takes as long as    
+/// the slowest chain of generators, instead of all of them together.         
+/// Data is committed only between waves, on the calling thread. Generators   
+/// that ask for data no earlier wave has made - like bounds asking for       
+/// missing indices - are run again after their wave, one at a time           
+void Mesh::GenerateAll() {
+   if (not IsReady())
+      return;
+
+   if (mPrimitive)
+      mLastUse = GetLibrary()->NextUse();
+
+   // Generators in a wave never wait for this lock, while it's held    
+   // here - they find data without it, see Mesh::Generate              
+   ::std::lock_guard lock {mGenerateMutex};
+   PublishGenerated();
+
+   // Materials aren't vertex data, and the bounding volume hierarchy   
+   // is only for queries, so they're generated only on demand          
+   TMany<TMeta> pending;
+   ForEachStream<EvictableStreams>([&]<class T>(Offset) {
+      if constexpr (CT::Exact<T, Traits::Bvh>)
+         return;
+      if (not CountData(MetaOf<T>()) and mGenerators.FindIt(MetaOf<T>()))
+         pending << MetaOf<T>();
+   });
+
+   while (pending) {
+      // Gather the generators, whose dependencies are all committed.   
+      // Generators with dependencies that can't be made are skipped    
+      TMany<TMeta> wave;
+      TMany<TMeta> blocked;
+      for (auto trait : pending) {
+         bool ready = true;
+         bool possible = true;
+         const auto found = mDependencies.FindIt(trait);
+         if (found) {
+            for (auto dependency : found.GetValue()) {
+               for (auto other : pending)
+                  ready &= other != dependency;
+               possible &= CountData(dependency) > 0;
+            }
+         }
+
+         if (not ready)
+            blocked << trait;
+         else if (possible)
+            wave << trait;
+      }
+
+      if (not wave) {
+         LANGULUS_ASSERT(not blocked, Mesh, "Circular generator dependencies");
+         break;
+      }
+
+      // Streams aren't POD, so they're constructed before the workers  
+      // assign to them                                                 
+      ::std::vector<StreamCache::Streams> streams(wave.GetCount());
+      TMany<bool> shared;
+      shared.template Reserve<true>(wave.GetCount());
+      TMany<bool> deferred;
+      deferred.template Reserve<true>(wave.GetCount());
+      for (auto& d : deferred)
+         d = false;
+
+      GetLibrary()->GetWorkers().ForEach(wave.GetCount(), [&](Offset i) {
+         const auto generator = mGenerators.FindIt(wave[i]).GetValue();
+         WaveGenerator current {this, &deferred[i]};
+         const auto previous = Waving;
+         Waving = &current;
+         try { streams[i] = Prepare(wave[i], generator, shared[i]); }
+         catch (...) {
+            Waving = previous;
+            throw;
+         }
+
+         Waving = previous;
+      });
+
+      for (Offset i = 0; i < wave.GetCount(); ++i) {
+         if (deferred[i])
+            continue;
+
+         const auto generator = mGenerators.FindIt(wave[i]).GetValue();
+         Adopt(wave[i], generator, streams[i], shared[i]);
+      }
+
+      PublishGenerated();
+
+      // Deferred generators made their data from incomplete streams,   
+      // so it's thrown away, and they're run again under the lock,     
+      // generating whatever they're missing along the way              
+      for (Offset i = 0; i < wave.GetCount(); ++i) {
+         if (not deferred[i] or CountData(wave[i]))
+            continue;
+
+         RunGenerator(wave[i], mGenerators.FindIt(wave[i]).GetValue());
+      }
+
+      PublishGenerated();
+      pending = Abandon(blocked);
+   }
+}
+
+/// Check if the mesh has finished loading. Meshes that are loaded in the     
+/// background have no data, and their view is written by the loader until    
+/// then, so neither should be read before this returns true                  
+///   @return true if the data is ready                                       
+bool Mesh::IsReady() const {
+   return mReady.load(::std::memory_order_acquire);
+}
+
+/// Block until the mesh has finished loading in the background               
+void Mesh::Wait() const {
+   mReady.wait(false, ::std::memory_order_acquire);
+}
+
+/// Inspect the geometry parsed so far, while the mesh is loaded in the       
+/// background progressively. Data lists are indexed separately, like in the  
+/// file, and are empty when there's nothing to show - before the first step  
+/// is parsed, and after loading is done, when the committed data should be   
+/// used instead. Parsing continues while the reader runs, but the reader     
+/// must not keep the pointers for later                                      
+///   @param reader - receives the geometry parsed so far                     
+void Mesh::ReadProgress(const ::std::function<void(const Progress&)>& reader) const {
+   ::std::lock_guard lock {mProgressMutex};
+   reader(mProgress);
+}
+
+/// Get the time the data of a generated mesh was last requested              
+///   @return the timestamp, as given by MeshLibrary::NextUse                 
+auto Mesh::GetLastUse() const -> uint64_t {
+   return mLastUse;
+}
+
+/// Get all data lists that can be evicted, and generated again. Generators   
+/// might be committing to the mesh on other threads, so the lists are        
+/// looked up under the generator lock, and only their footprint is returned  
+///   @return where each data list is, and its size in bytes                  
+auto Mesh::GetDataLists() const -> TMany<Footprint> {
+   ::std::lock_guard lock {mGenerateMutex};
+   TMany<Footprint> result;
+   ForEachStream<EvictableStreams>([&]<class T>(Offset) {
+      const auto count = CountData(MetaOf<T>());
+      for (Offset i = 0; i < count; ++i) {
+         const auto data = GetData<T>(i);
+         result << Footprint {data->GetRaw(), data->GetBytesize()};
+      }
+   });
+   return result;
+}
+
+/// Pin a mesh, before generating the data that is about to be read           
+///   @param mesh - the mesh to pin                                           
+Mesh::Pin::Pin(const Mesh& mesh) noexcept
+   : mMesh {mesh} {
+   mMesh.mReaders.fetch_add(1);
+}
+
+/// Unpin the mesh, once done reading its data                                
+Mesh::Pin::~Pin() {
+   mMesh.mReaders.fetch_sub(1, ::std::memory_order_release);
+}
+
+/// Release all generated data. Generators are kept, so the data is made      
+/// again the next time it is requested via Generate. Meshes that are pinned  
+/// are left as they are, instead of waiting for their readers. Meshes that   
+/// weren't made with Traits::Evictable are never evicted, because their      
+/// readers don't pin them                                                    
+///   @return true if the data was released                                   
+bool Mesh::Evict() {
+   if (not mEvictable)
+      return false;
+
+   ::std::lock_guard lock {mGenerateMutex};
+   if (mReaders.load() != 0)
+      return false;
+
+   // Readers pin before they look for the generated counts, and they   
+   // are hidden before the pins are checked again. So a reader either  
+   // is seen here, or finds nothing and waits for the lock to generate 
+   for (auto& generated : mGenerated)
+      generated.store(0);
+
+   if (mReaders.load() != 0) {
+      PublishGenerated();
+      return false;
+   }
+
+   ForEachStream<EvictableStreams>([&]<class T>(Offset) {
+      auto found = mDataListMap.FindIt(MetaOf<T>());
+      if (found)
+         found.GetValue().Clear();
+   });
+   return true;
+}
+
+/// Copy an index stream as 32-bit indices, for processing                    
+///   @param index - the index stream, meshes that are indexed separately     
+///      for each attribute have more than one                                
+///   @return the indices, or an empty container if the stream doesn't exist  
+///      or isn't made of 16 or 32-bit indices                                
+auto Mesh::GatherIndices(Offset index) const -> TMany<uint32_t> {
+   TMany<uint32_t> result;
+   const auto stream = GetData<Traits::Index>(index);
+   if (not stream or stream->IsEmpty())
+      return result;
+
+   if (stream->GetStride() == sizeof(uint16_t)) {
+      result.Reserve<true>(stream->GetCount());
+      auto from = reinterpret_cast<const uint16_t*>(stream->GetRaw());
+      for (auto& i : result)
+         i = *from++;
+   }
+   else if (stream->GetStride() == sizeof(uint32_t)) {
+      result.Reserve<true>(stream->GetCount());
+      ::std::memcpy(result.GetRaw(), stream->GetRaw(), stream->GetBytesize());
+   }
+
+   return result;
+}
+
+/// Replace 32-bit indices with 16-bit ones, if they all fit, halving the     
+/// index bandwidth. Nearly all generated meshes and props are small enough   
+///   @param indices - [in/out] the indices to narrow, left as they are if    
+///      they aren't 32-bit, or don't fit                                     
+void Mesh::NarrowIndices(Many& indices) {
+   if (indices.IsEmpty() or not indices.template IsExact<uint32_t>())
+      return;
+
+   const auto from = reinterpret_cast<const uint32_t*>(indices.GetRaw());
+   const auto count = indices.GetCount();
+   uint32_t max = 0;
+   for (Offset i = 0; i < count; ++i)
+      max = ::std::max(max, from[i]);
+   if (max > 0xFFFF)
+      return;
+
+   TMany<uint16_t> narrow;
+   narrow.Reserve<true>(count);
+   for (Offset i = 0; i < count; ++i)
+      narrow[i] = static_cast<uint16_t>(from[i]);
+   indices = Many {Abandon(narrow)};
+}
+
+/// Get the bounding volumes and surface area of the mesh. They're computed   
+/// only once, and kept with the rest of the data                             
+///   @return the bounds, all zero if the mesh has no positions               
+auto Mesh::GetBounds() -> MeshBounds {
+   const Pin pin {*this};
+   if (not Generate(MetaOf<Traits::Bounds>()))
+      return {};
+   return *reinterpret_cast<const MeshBounds*>(GetData<Traits::Bounds>()->GetRaw());
+}
+
+/// Copy the positions as single precision 3D points, for processing          
+///   @return the positions, or an empty container if there are none          
+auto Mesh::GatherPositions() const -> TMany<Vec3f> {
+   TMany<Vec3f> result;
+   const auto stream = GetData<Traits::Place>();
+   if (not stream or stream->IsEmpty())
+      return result;
+
+   if (stream->template IsExact<Vec3f>()) {
+      result.Reserve<true>(stream->GetCount());
+      ::std::memcpy(static_cast<void*>(result.GetRaw()),
+         stream->GetRaw(), stream->GetBytesize());
+   }
+   else {
+      result.Reserve(stream->GetCount());
+      for (Offset i = 0; i < stream->GetCount(); ++i)
+         result << stream->template AsCast<Vec3f>(i);
+   }
+
+   return result;
+}
+
+/// Pack the separate vertex streams into a single interleaved buffer, in     
+/// a single pass over the vertices. Only streams with an element for each    
+/// position are per vertex, so the rest are left out                         
+///   @param model - the mesh to interleave                                   
+void Mesh::GenerateInterleaved(Mesh* model) {
+   // Interleaved vertices are made of other streams, that might be     
+   // generated                                                         
+   model->Generate(MetaOf<Traits::Place>());
+   model->Generate(MetaOf<Traits::Aim>());
+   model->Generate(MetaOf<Traits::Sampler>());
+   model->Generate(MetaOf<Traits::Color>());
+
+   const auto positions = model->GetData<Traits::Place>();
+   if (not positions or positions->IsEmpty())
+      return;
+
+   // Meshes indexed separately for each attribute must be welded first 
+   if (model->GetData<Traits::Index>(1))
+      return;
+
+   const Many* streams[VertexLayout::AttributeCount] {
+      positions,
+      model->GetData<Traits::Aim>(),
+      model->GetData<Traits::Sampler>(),
+      model->GetData<Traits::Color>()
+   };
+
+   const auto vertices = positions->GetCount();
+   Count sizes[VertexLayout::AttributeCount] {};
+   for (uint32_t a = 0; a < VertexLayout::AttributeCount; ++a) {
+      if (streams[a] and streams[a]->GetCount() == vertices)
+         sizes[a] = streams[a]->GetStride();
+   }
+
+   auto layout = VertexLayout::Describe(sizes, model->mQuantize);
+   if (layout.mEncodings[VertexLayout::Position] == VertexLayout::Unorm16)
+      layout.Bound(reinterpret_cast<const Byte*>(positions->GetRaw()), vertices);
+
+   Bytes buffer;
+   buffer.Reserve<true>(vertices * layout.mStride);
+   ::std::memset(buffer.GetRaw(), 0, vertices * layout.mStride);
+
+   for (Offset v = 0; v < vertices; ++v) {
+      const auto vertex = buffer.GetRaw() + v * layout.mStride;
+      for (uint32_t a = 0; a < VertexLayout::AttributeCount; ++a) {
+         if (not sizes[a])
+            continue;
+
+         const auto element = reinterpret_cast<const Byte*>(streams[a]->GetRaw()) + v * sizes[a];
+         layout.Write(vertex, static_cast<VertexLayout::Attribute>(a), element);
+      }
+   }
+
+   TMany<VertexLayout> layouts;
+   layouts << layout;
+   model->Commit<Traits::Interleave>(Abandon(buffer));
+   model->Commit<Traits::Interleave>(Abandon(layouts));
+}
+
+/// Build the bounding volume hierarchy of a mesh                             
+///   @param model - the mesh to build the hierarchy for                      
+void Mesh::GenerateBvh(Mesh* model) {
+   // The hierarchy is built from other streams, that might be generated
+   model->Generate(MetaOf<Traits::Index>());
+   model->Generate(MetaOf<Traits::Place>());
+
+   const auto topology = model->mView.mTopology;
+   if (not topology
+   or topology->CastsTo<A::TriangleStrip>()
+   or not topology->CastsTo<A::Triangle>())
+      return;
+
+   // Position indices come first, even if attributes are indexed       
+   // separately. Triangle lists without indices are sequential         
+   const auto positions = model->GatherPositions();
+   auto indices = model->GatherIndices();
+   if (indices.IsEmpty() and not model->GetData<Traits::Index>()) {
+      indices.Reserve<true>(positions.GetCount());
+      for (Offset i = 0; i < indices.GetCount(); ++i)
+         indices[i] = static_cast<uint32_t>(i);
+   }
+
+   const auto valid = ::std::all_of(indices.begin(), indices.end(),
+      [&](uint32_t i) { return i < positions.GetCount(); });
+   if (indices.GetCount() < 3 or not valid)
+      return;
+
+   TMany<BvhNode>  nodes;
+   TMany<uint32_t> triangles;
+   TMany<Vec3f>    vertices;
+   Bvh::Build(positions, indices, model->GetLibrary()->GetWorkers(),
+      nodes, triangles, vertices);
+
+   model->Commit<Traits::Bvh>(Abandon(nodes));
+   model->Commit<Traits::Bvh>(Abandon(triangles));
+   model->Commit<Traits::Bvh>(Abandon(vertices));
+}
+
+/// Find the closest triangle a ray hits. The bounding volume hierarchy is    
+/// built on the first query, so only meshes that are queried pay for it      
+///   @param origin - where the ray starts                                    
+///   @param direction - the ray direction, doesn't have to be normalized     
+///   @param hit - [out] the closest hit, with a distance in units of the     
+///      direction                                                            
+///   @param maxDistance - hits further than this are ignored, in units of    
+///      the direction                                                        
+///   @return true if a triangle was hit                                      
+bool Mesh::Raycast(const Vec3f& origin, const Vec3f& direction, RayHit& hit, float maxDistance) {
+   const Pin pin {*this};
+   if (not Generate(MetaOf<Traits::Bvh>(), 2))
+      return false;
+
+   return Bvh::Intersect(
+      reinterpret_cast<const BvhNode*>(GetData<Traits::Bvh>(0)->GetRaw()),
+      reinterpret_cast<const uint32_t*>(GetData<Traits::Bvh>(1)->GetRaw()),
+      reinterpret_cast<const Vec3f*>(GetData<Traits::Bvh>(2)->GetRaw()),
+      origin, direction, maxDistance, hit
+   );
+}
+
+/// Find the triangle closest to the start of a segment, that the segment     
+/// crosses                                                                   
+///   @param from - start of the segment                                      
+///   @param to - end of the segment                                          
+///   @param hit - [out] the closest hit, with a distance between zero at     
+///      the start and one at the end of the segment                          
+///   @return true if a triangle was hit                                      
+bool Mesh::Linecast(const Vec3f& from, const Vec3f& to, RayHit& hit) {
+   const Vec3f direction {to[0] - from[0], to[1] - from[1], to[2] - from[2]};
+   return Raycast(from, direction, hit, 1);
+}
+
+/// Find the closest triangle for each ray of a batch, at once. Coherent      
+/// rays, like the ones for picking or decal projection, are the fastest      
+///   @param rays - the batch of rays                                         
+///   @param hits - [out] a hit for each ray, with RayHit::Miss as triangle   
+///      for rays that didn't hit anything                                    
+///   @return the number of rays that hit a triangle                          
+auto Mesh::Raycast(const RayBatch& rays, RayHit* hits) -> Count {
+   const Pin pin {*this};
+   if (not Generate(MetaOf<Traits::Bvh>(), 2)) {
+      for (Offset i = 0; i < rays.mCount; ++i)
+         hits[i] = {FLT_MAX, RayHit::Miss, 0, 0};
+      return 0;
+   }
+
+   return Bvh::Intersect(
+      reinterpret_cast<const BvhNode*>(GetData<Traits::Bvh>(0)->GetRaw()),
+      reinterpret_cast<const uint32_t*>(GetData<Traits::Bvh>(1)->GetRaw()),
+      reinterpret_cast<const Vec3f*>(GetData<Traits::Bvh>(2)->GetRaw()),
+      rays, hits
+   );
 }
 
 /// Get level of detail mesh                                                  
@@ -124,10 +904,15 @@ bool Mesh::AutocompleteDescriptor(Construct& desc) {
       topology = trait.As<DMeta>();
    });
 
-   return AutocompleteInner<GenerateBox,  Box2 >(desc, primitive, topology)
-       or AutocompleteInner<GenerateBox,  Box3 >(desc, primitive, topology)
-       or AutocompleteInner<GenerateGrid, Grid2>(desc, primitive, topology)
-       or AutocompleteInner<GenerateGrid, Grid3>(desc, primitive, topology);
+   const auto generators = FindGenerators(primitive);
+   if (not generators)
+      return false;
+
+   const auto slot = topology
+      ? TopologySlot(topology) : generators->mFallback;
+   if (slot == TopologyCount or not generators->mDefault[slot])
+      return false;
+   return generators->mDefault[slot](desc);
 }
 
 /// Populate the mesh view and generator functions, by analyzing descriptor   
@@ -140,11 +925,21 @@ bool Mesh::FromDescriptor(const Many& desc) {
    desc.ExtractTrait<Traits::Topology >(mView.mTopology);
    desc.ExtractTrait<Traits::Bilateral>(mView.mBilateral);
    desc.ExtractTrait<Traits::MapMode  >(mView.mTextureMapping);
-   
-   return FillGenerators<GenerateBox,  Box2 >(primitive)
-       or FillGenerators<GenerateBox,  Box3 >(primitive)
-       or FillGenerators<GenerateGrid, Grid2>(primitive)
-       or FillGenerators<GenerateGrid, Grid3>(primitive);
+   desc.ExtractTrait<Traits::Optimize >(mOptimize);
+
+   const auto generators = FindGenerators(primitive);
+   if (not generators)
+      return false;
+
+   mPrimitive = primitive;
+
+   LANGULUS_ASSUME(DevAssumes, mView.mTopology, "Topology not set");
+   const auto slot = TopologySlot(mView.mTopology);
+   LANGULUS_ASSERT(slot != TopologyCount and generators->mFill[slot],
+      Mesh, "Unsupported topology: ", mView.mTopology);
+
+   (this->*generators->mFill[slot])();
+   return true;
 }
 
 /// Load mesh via filename/file interface                                     
@@ -155,15 +950,217 @@ bool Mesh::FromFile(const Many& desc) {
       desc.ExtractDataAs(filename);
 
    if (filename) {
+      desc.ExtractTrait<Traits::Weld>(mWeld);
+
+      // Interleaved vertices need a single index buffer                
+      if (mInterleave)
+         mWeld = true;
+      desc.ExtractTrait<Traits::Optimize>(mOptimize);
+      desc.ExtractTrait<Traits::Simplify>(mSimplify);
+      desc.ExtractTrait<Traits::Progressive>(mProgressive);
+
+      bool async = false;
+      desc.ExtractTrait<Traits::Async>(async);
+
       // Load a filename if such was provided                           
-      auto fileInterface = GetProducer()->GetFolder()->RelativeFile(filename);
-      if (fileInterface)
-         return ReadOBJ(*fileInterface);
+      auto folder = GetProducer()->GetFolder();
+      auto fileInterface = folder->RelativeFile(filename);
+      if (fileInterface) {
+         auto cacheInterface = folder->RelativeFile(filename + ".cache");
+
+         // Files requested in a batch are loaded in parallel, and the  
+         // library waits for them at the end of the batch              
+         const auto batch = GetLibrary()->GetBatch();
+         if (not async and not batch) {
+            if (not Load(*fileInterface, cacheInterface ? &*cacheInterface : nullptr))
+               return false;
+
+            mLODgenerator = SimplifiedDetail;
+            return true;
+         }
+
+         // The mesh is available right away, but has no data until the 
+         // workers are done with it. The data is published all at once 
+         // by the ready flag, so it is never observed half-loaded. The 
+         // loader is pushed to the workers at the end of construction  
+         mLODgenerator = SimplifiedDetail;
+         mReady.store(false, ::std::memory_order_relaxed);
+         mLoader = [this, fileInterface, cacheInterface] {
+            try {
+               if (not Load(*fileInterface, cacheInterface ? &*cacheInterface : nullptr))
+                  Logger::Error(Self(), "Couldn't load mesh ", fileInterface->GetFilePath());
+            }
+            catch (...) {
+               Logger::Error(Self(), "Couldn't load mesh ", fileInterface->GetFilePath());
+            }
+
+            mReady.store(true, ::std::memory_order_release);
+            mReady.notify_all();
+         };
+         return true;
+      }
    }
 
    return false;
 }
 
+/// Load the mesh data from a file, or from its binary cache                  
+///   @param file - the source file                                           
+///   @param cache - the cache next to the source file, can be nullptr        
+///   @return true if the mesh was loaded                                     
+bool Mesh::Load(const A::File& file, const A::File* cache) {
+   // Prefer the binary cache next to the file, if it is still up to    
+   // date with the source                                              
+   if (not cache or not ReadCache(*cache, file)) {
+      if (not ReadOBJ(file))
+         return false;
+
+      if (mOptimize)
+         Optimize();
+
+      if (cache)
+         WriteCache(*cache, file);
+   }
+
+   // Levels of detail are simplified from the full mesh, which is      
+   // shared with the other levels through the cache                    
+   if (mSimplify) {
+      Simplify(mSimplify);
+      if (mOptimize)
+         Optimize();
+   }
+
+   // Simplifying starts the data lists over                            
+   ReserveDataLists();
+   return true;
+}
+
+/// Load OBJ file                                                             
+///   @param file - [in/out] the file to load from                            
+///   @return true if model was loaded without any problems                   
+bool Mesh::ReadOBJ(const A::File& file) {
+   auto loadTime = SteadyClock::Now();
+
+   // Empty mesh                                                        
+   Obj::Mesh m;
+
+   // Geometry parsed so far is published for viewers, when loading     
+   // progressively                                                     
+   const auto publish = [this](const Obj::Mesh& parsed) {
+      ::std::lock_guard lock {mProgressMutex};
+      mProgress.mPositions = parsed.positions.GetRaw();
+      mProgress.mNormals = parsed.normals.GetRaw();
+      mProgress.mTextureCoords = parsed.texcoords.GetRaw();
+      mProgress.mPositionCount = parsed.positions.GetCount();
+      mProgress.mNormalCount = parsed.normals.GetCount();
+      mProgress.mTextureCoordCount = parsed.texcoords.GetCount();
+      mProgress.mPositionIndices = parsed.mPositionIndices.GetRaw();
+      mProgress.mNormalIndices = parsed.mNormalIndices.GetRaw();
+      mProgress.mTextureIndices = parsed.mTextureIndices.GetRaw();
+      mProgress.mIndexCount = parsed.mPositionIndices.GetCount();
+   };
+
+   // Parse the whole file in parallel if the file system can give it   
+   // to us as one contiguous block, otherwise stream it                
+   auto& workers = GetLibrary()->GetWorkers();
+   if (not Obj::read_view(m, file, workers, mProgressive * 1024 * 1024, publish))
+      Obj::read_chunked(m, file);
+
+   // The parsed data is about to be committed, or welded, so it is no  
+   // longer published                                                  
+   {
+      ::std::lock_guard lock {mProgressMutex};
+      mProgress = {};
+   }
+
+   // Flush final object/group                                          
+   mView.mPrimitiveCount = static_cast<uint32_t>(m.face_vertices.GetCount());
+   mView.mIndexCount = static_cast<uint32_t>(m.mPositionIndices.GetCount());
+   mView.mTextureMapping = m.texcoords.IsEmpty()
+      ? Math::MapModeType::Model
+      : Math::MapModeType::Custom;
+   mView.mTopology = MetaDataOf<A::Triangle>();
+
+   /*m.material_count = m.materials.GetCount();
+   m.object_count = m.objects.GetCount();
+   m.group_count = m.groups.GetCount();*/
+
+   // Bound only the referenced positions, so neither the dummy one at  
+   // index zero, nor any unused ones count. Welding only drops unused  
+   // positions, so the bounds stay valid                               
+   if (m.positions.GetCount() > 1) {
+      TMany<MeshBounds> bounds;
+      bounds << MeshBounds::FromIndexed(
+         m.positions.GetRaw(), m.positions.GetCount(),
+         m.mPositionIndices.GetRaw(), m.mPositionIndices.GetCount());
+      bounds[0].mArea = MeshBounds::TriangleArea(
+         m.positions.GetRaw(), m.positions.GetCount(),
+         m.mPositionIndices.GetRaw(), m.mPositionIndices.GetCount());
+      Commit<Traits::Bounds>(Abandon(bounds));
+   }
+
+   if (mWeld) {
+      // Unify the attributes under a single index buffer, and save it. 
+      // Interleaved vertices are written while welding, if requested,  
+      // unless vertices are about to be reordered or simplified - they 
+      // are packed on demand afterwards instead                        
+      const bool interleave = mInterleave and not mOptimize and not mSimplify;
+      VertexLayout layout;
+      if (interleave) {
+         // Colors are in the layout whenever they would be without     
+         // welding, so that the layout doesn't depend on it            
+         layout = VertexLayout::Describe({
+            sizeof(Vec3f), sizeof(Vec3f), sizeof(Vec2f),
+            m.colors ? sizeof(Vec3f) : 0
+         }, mQuantize);
+
+         // Quantized positions are fit to the parsed ones, without the 
+         // dummy position at index zero                                
+         if (layout.mEncodings[VertexLayout::Position] == VertexLayout::Unorm16
+         and m.positions.GetCount() > 1) {
+            layout.Bound(reinterpret_cast<const Byte*>(m.positions.GetRaw() + 1),
+               m.positions.GetCount() - 1);
+         }
+      }
+
+      auto welded = Weld::Unify(
+         m.positions, m.normals, m.texcoords, m.colors,
+         m.mPositionIndices, m.mNormalIndices, m.mTextureIndices,
+         interleave ? &layout : nullptr
+      );
+
+      if (interleave) {
+         TMany<VertexLayout> layouts;
+         layouts << layout;
+         Commit<Traits::Interleave>(Move(welded.interleaved));
+         Commit<Traits::Interleave>(Abandon(layouts));
+      }
+
+      Commit<Traits::Place>   (Move(welded.positions));
+      Commit<Traits::Aim>     (Move(welded.normals));
+      Commit<Traits::Sampler> (Move(welded.texcoords));
+      Commit<Traits::Color>   (Move(welded.colors));
+      Commit<Traits::Index>   (Move(welded.indices));
+
+      Logger::Verbose(Logger::Green, "File ", file.GetFilePath(),
+         " loaded and welded in ", SteadyClock::Now() - loadTime);
+      return true;
+   }
+
+   // Save the contents                                                 
+   Commit<Traits::Place>   (Move(m.positions));
+   Commit<Traits::Aim>     (Move(m.normals));
+   Commit<Traits::Sampler> (Move(m.texcoords));
+   Commit<Traits::Color>   (Move(m.colors));
+   Commit<Traits::Index>   (Traits::Place   {Move(m.mPositionIndices)});
+   Commit<Traits::Index>   (Traits::Aim     {Move(m.mNormalIndices)});
+   Commit<Traits::Index>   (Traits::Sampler {Move(m.mTextureIndices)});
+
+   Logger::Verbose(Logger::Green, "File ", file.GetFilePath(),
+      " loaded in ", SteadyClock::Now() - loadTime);
+   return true;
+}
+
 #define HasGenerator(a) ::std::is_invocable_v<decltype(&a), Mesh*>
 
 ///                                                                           
@@ -181,50 +1178,88 @@ void Mesh::FillGeneratorsInner() {
       mGenerators.Insert(MetaOf<Traits::Material>(),   GENERATOR::Materials);
    if constexpr (HasGenerator(GENERATOR::Detail))
       mLODgenerator = GENERATOR::Detail;
-}
 
-///                                                                           
-template<template<typename...> class GENERATOR, class PRIMITIVE>
-bool Mesh::FillGenerators(DMeta primitive) {
-   if (not primitive->CastsTo<PRIMITIVE>())
-      return false;
+   // Some generators make their data out of the generated positions    
+   if constexpr (requires { typename GENERATOR::FromPositions; }) {
+      ForEachStream<typename GENERATOR::FromPositions>([&]<class T>(Offset) {
+         mDependencies.Insert(MetaOf<T>(), TMany<TMeta> {MetaOf<Traits::Place>()});
+      });
+   }
 
-   LANGULUS_ASSUME(DevAssumes, mView.mTopology, "Topology not set");
-   if (mView.mTopology->CastsTo<A::TriangleStrip>())
-      FillGeneratorsInner<GENERATOR<PRIMITIVE, A::TriangleStrip>>();
-   else if (mView.mTopology->CastsTo<A::Triangle>())
-      FillGeneratorsInner<GENERATOR<PRIMITIVE, A::Triangle>>();
-   else if (mView.mTopology->CastsTo<A::LineStrip>())
-      FillGeneratorsInner<GENERATOR<PRIMITIVE, A::LineStrip>>();
-   else if (mView.mTopology->CastsTo<A::Line>())
-      FillGeneratorsInner<GENERATOR<PRIMITIVE, A::Line>>();
-   else if (mView.mTopology->CastsTo<A::Point>())
-      FillGeneratorsInner<GENERATOR<PRIMITIVE, A::Point>>();
-   else
-      LANGULUS_OOPS(Mesh, "Unsupported topology: ", mView.mTopology);
-   return true;
+   mShareStreams = not requires { GENERATOR::PerDescriptor; };
 }
 
-///                                                                           
-template<template<typename...> class GENERATOR, class PRIMITIVE>
-bool Mesh::AutocompleteInner(Construct& out, DMeta primitive, DMeta topology) {
-   if (not primitive->CastsTo<PRIMITIVE>())
-      return false;
-   
-   if (not topology)
-      return GENERATOR<PRIMITIVE>::Default(out);
-   else if (topology->CastsTo<A::TriangleStrip>())
-      return GENERATOR<PRIMITIVE, A::TriangleStrip>::Default(out);
-   else if (topology->CastsTo<A::Triangle>())
-      return GENERATOR<PRIMITIVE, A::Triangle>::Default(out);
-   else if (topology->CastsTo<A::LineStrip>())
-      return GENERATOR<PRIMITIVE, A::LineStrip>::Default(out);
-   else if (topology->CastsTo<A::Line>())
-      return GENERATOR<PRIMITIVE, A::Line>::Default(out);
-   else if (topology->CastsTo<A::Point>())
-      return GENERATOR<PRIMITIVE, A::Point>::Default(out);
-   else
-      return false;
+/// A generator registered for a primitive, for the given topologies          
+template<template<typename...> class GENERATOR, class PRIMITIVE, class...TOPOLOGY>
+struct Mesh::Registered {
+   static_assert(sizeof...(TOPOLOGY) > 0, "No topology registered");
+   using Primitive = PRIMITIVE;
+
+   static auto Make() -> GeneratorSet {
+      GeneratorSet set;
+      (Add<TOPOLOGY>(set), ...);
+      return set;
+   }
+
+   template<class T>
+   static void Add(GeneratorSet& set) {
+      constexpr auto slot = TopologySlot<T>();
+      set.mDefault[slot] = GENERATOR<PRIMITIVE, T>::Default;
+      set.mFill[slot] = &Mesh::FillGeneratorsInner<GENERATOR<PRIMITIVE, T>>;
+      if (set.mFallback == TopologyCount)
+         set.mFallback = slot;
+   }
+};
+
+/// Find the generators for a primitive                                       
+///   @param primitive - the primitive type                                   
+///   @return the generators, or nullptr if primitive can't be generated      
+auto Mesh::FindGenerators(DMeta primitive) -> const GeneratorSet* {
+   using Registry = TypeList<
+      Registered<GenerateBox,      Box2,            A::Triangle, A::TriangleStrip, A::Line, A::LineStrip, A::Point>,
+      Registered<GenerateBox,      Box3,            A::Triangle, A::TriangleStrip, A::Line, A::LineStrip, A::Point>,
+      Registered<GenerateGrid,     Grid2,           A::Triangle, A::TriangleStrip, A::Line, A::LineStrip, A::Point>,
+      Registered<GenerateGrid,     Grid3,           A::Triangle, A::TriangleStrip, A::Line, A::LineStrip, A::Point>,
+      Registered<GenerateSphere,   TSphere<Vec3>,   A::Triangle>,
+      Registered<GenerateCylinder, TCylinder<Vec3>, A::Triangle>,
+      Registered<GenerateFrustum,  TFrustum<Vec3>,  A::Triangle>,
+      Registered<GenerateTriangle, TTriangle<Vec3>, A::Triangle>,
+      Registered<GenerateLine,     TLine<Vec3>,     A::Line>,
+      Registered<GenerateLabel,    TLabel<Vec3>,    A::Triangle>,
+      Registered<GenerateZode,     TZode<Vec3>,     A::TriangleStrip>
+   >;
+
+   struct Table {
+      TMany<GeneratorSet> mSets;
+      TMany<DMeta> mPrimitives;
+      TUnorderedMap<DMeta, Offset> mIndex;
+
+      void Register(DMeta primitive, const GeneratorSet& set) {
+         mIndex.Insert(primitive, mSets.GetCount());
+         mPrimitives << primitive;
+         mSets << set;
+      }
+   };
+
+   // Built once, the first time a generated mesh is requested          
+   static const Table table = []<class...ENTRY>(TypeList<ENTRY...>) {
+      Table result;
+      (result.Register(MetaDataOf<typename ENTRY::Primitive>(), ENTRY::Make()), ...);
+      return result;
+   }(Registry {});
+
+   // Primitives are almost always given by their exact type            
+   const auto found = table.mIndex.FindIt(primitive);
+   if (found)
+      return &table.mSets[found.GetValue()];
+
+   // Otherwise fall back to the first primitive it converts to         
+   for (Offset i = 0; i < table.mPrimitives.GetCount(); ++i) {
+      if (primitive->CastsTo(table.mPrimitives[i]))
+         return &table.mSets[i];
+   }
+
+   return nullptr;
 }
 
 /// Get the mesh library                                                      
@@ -7,6 +7,9 @@
 ///                                                                           
 #pragma once
 #include "Common.hpp"
+#include "Streams.hpp"
+#include "Bounds.hpp"
+#include "Bvh.hpp"
 #include <Langulus/Math/Primitives/Box.hpp>
 #include <Langulus/Math/Primitives/Triangle.hpp>
 #include <Langulus/Math/Primitives/Line.hpp>
@@ -14,6 +17,10 @@
 #include <Langulus/Math/Mapping.hpp>
 #include <Langulus/Math/Color.hpp>
 #include <Langulus/Material.hpp>
+#include <atomic>
+#include <cfloat>
+#include <mutex>
+#include <functional>
 
 //TODO Unfortunately, due to compiler bugs in MSVC and Clang, we can't
 // generalize these generators yet. Some day we will...
@@ -24,6 +31,12 @@
 ///                                                                           
 ///   A mesh asset                                                            
 ///                                                                           
+/// Data found via GetData stays valid for as long as the mesh exists, unless 
+/// the mesh was made with Traits::Evictable. The generated data of such      
+/// meshes can be released at any time to fit the library's memory budget,    
+/// so they must be pinned while read - see Mesh::Pin. Readers that see only  
+/// an A::Mesh can't pin it, so evictable meshes must never be handed to them 
+///                                                                           
 struct Mesh final : A::Mesh {
    LANGULUS(ABSTRACT) false;
    LANGULUS(PRODUCER) MeshLibrary;
@@ -33,35 +46,194 @@ struct Mesh final : A::Mesh {
 
 public:
    Mesh(MeshLibrary*, const Many&);
+   ~Mesh();
 
    void Refresh();
    void Create(Verb&);
    bool Generate(TMeta, Offset = 0);
+   void GenerateAll();
+   void Optimize(bool vertices = true);
+   void Simplify(Count level);
+
+   auto GatherIndices(Offset = 0) const -> TMany<uint32_t>;
+   auto GatherPositions() const -> TMany<Vec3f>;
+   auto GetBounds() -> MeshBounds;
+   bool Raycast(const Vec3f&, const Vec3f&, RayHit&, float maxDistance = FLT_MAX);
+   bool Linecast(const Vec3f&, const Vec3f&, RayHit&);
+   auto Raycast(const RayBatch&, RayHit*) -> Count;
 
    auto GetLOD(const LOD&) const -> Ref<A::Mesh>;
    auto GetLibrary() const -> MeshLibrary*;
+   auto GetLastUse() const -> uint64_t;
+   /// Where a data list is in memory, and how big it is                      
+   struct Footprint {
+      const void* mRaw;
+      Count mBytes;
+   };
+
+   auto GetDataLists() const -> TMany<Footprint>;
+   bool Evict();
+
+   /// Keeps the generated data of a mesh from being evicted, while it is     
+   /// read. Data found via GetData stays valid while the mesh is pinned.     
+   /// Any number of threads can pin a mesh, even more than once              
+   class Pin {
+      const Mesh& mMesh;
+   public:
+      Pin(const Mesh&) noexcept;
+      Pin(const Pin&) = delete;
+      ~Pin();
+   };
+
+   template<CT::Trait T, class D>
+   void Commit(D&&);
+
+   bool IsReady() const;
+   void Wait() const;
+
+   /// Geometry parsed so far, while a file is loaded progressively           
+   struct Progress {
+      const Vec3f*    mPositions = nullptr;
+      const Vec3f*    mNormals = nullptr;
+      const Vec2f*    mTextureCoords = nullptr;
+      Count           mPositionCount = 0;
+      Count           mNormalCount = 0;
+      Count           mTextureCoordCount = 0;
+
+      // Triangle list, with separate indices for each attribute        
+      const uint32_t* mPositionIndices = nullptr;
+      const uint32_t* mNormalIndices = nullptr;
+      const uint32_t* mTextureIndices = nullptr;
+      Count           mIndexCount = 0;
+   };
+
+   void ReadProgress(const ::std::function<void(const Progress&)>&) const;
    static bool AutocompleteDescriptor(Construct&);
 
 private:
-   template<template<typename...> class GENERATOR, class PRIMITIVE>
-   static bool AutocompleteInner(Construct&, DMeta, DMeta = {});
+   // Generators for a primitive, for each topology it supports         
+   struct GeneratorSet;
+   template<template<typename...> class, class, class...>
+   struct Registered;
+   static auto FindGenerators(DMeta) -> const GeneratorSet*;
 
    bool FromDescriptor(const Many&);
    bool FromFile(const Many&);
+   bool Load(const A::File&, const A::File*);
+   void RunGenerator(TMeta, void(*)(Mesh*));
+   auto Prepare(TMeta, void(*)(Mesh*), bool&) -> StreamCache::Streams;
+   void Adopt(TMeta, void(*)(Mesh*), StreamCache::Streams&, bool);
+   auto GetStreamKey(TMeta, void(*)(Mesh*)) const -> StreamCache::Key;
+
+   using FCommit = void(*)(Mesh*, const Many&);
+   static bool IsStaging();
+   static void NarrowIndices(Many&);
+   static void StageData(TMeta, FCommit, Many&&);
+   auto CountData(TMeta) const -> Count;
+   void ReserveDataLists();
+   static auto GetGeneratedSlot(TMeta) -> Offset;
+   void PublishGenerated();
 
-   template<template<typename...> class GENERATOR, class PRIMITIVE>
-   bool FillGenerators(DMeta);
    template<class GENERATOR>
    void FillGeneratorsInner();
 
+   static void GenerateMeshlets(Mesh*);
+   static void GenerateInterleaved(Mesh*);
+   static void GenerateBounds(Mesh*);
+   static void GenerateBvh(Mesh*);
+   static auto SimplifiedDetail(const Mesh*, const LOD&) -> Construct;
+
    bool ReadOBJ(const A::File&);
    //bool WriteOBJ(const A::File&) const;
 
+   bool ReadCache(const A::File&, const A::File&);
+   void WriteCache(const A::File&, const A::File&) const;
+
    // Generator functions for each supported type of data               
    using FGenerator = void(*)(Mesh*);
    TUnorderedMap<TMeta, FGenerator> mGenerators;
 
+   // Data lists that generators read, so they're generated before them 
+   TUnorderedMap<TMeta, TMany<TMeta>> mDependencies;
+
    // LOD generator function                                            
    using FLOD = Construct(*)(const Mesh*, const LOD&);
    FLOD mLODgenerator {};
+
+   // Whether file-based vertex attributes are unified under a single   
+   // index buffer upon loading                                         
+   bool mWeld = false;
+
+   // Whether indices (and vertices if possible) are reordered for the  
+   // GPU caches, after they're loaded or generated                     
+   bool mOptimize = false;
+
+   // Whether a single interleaved vertex buffer is made, in addition   
+   // to the separate vertex streams                                    
+   bool mInterleave = false;
+
+   // VertexLayout::Quantization bits, for attributes that are encoded  
+   // compactly in the interleaved vertex buffer                        
+   uint32_t mQuantize = 0;
+
+   // Primitive of a generated mesh, and whether the data generated for 
+   // it can be shared with other meshes through the library            
+   DMeta mPrimitive {};
+   bool mShareStreams = false;
+
+   // Whether the data of a generated mesh can be released, when over   
+   // the memory budget - only if the mesh was made evictable           
+   bool mEvictable = false;
+
+   // Simplification level of a file-based mesh, used for LOD           
+   Count mSimplify = 0;
+
+   // Megabytes of a file to parse between publishing the geometry      
+   // parsed so far, or zero to publish nothing until loaded            
+   Count mProgressive = 0;
+   Progress mProgress;
+   mutable ::std::mutex mProgressMutex;
+
+   // When the data of a generated mesh was last requested, so that the 
+   // least recently used data is evicted first                         
+   ::std::atomic<uint64_t> mLastUse {};
+
+   // Whether the mesh is done loading, false only while it is loaded   
+   // in the background                                                 
+   ::std::atomic<bool> mReady {true};
+
+   // Loads the file in the background, pushed to the workers once the  
+   // mesh is fully constructed                                         
+   ::std::function<void()> mLoader;
+
+   // Number of groups of each generated data list, published after     
+   // they're committed, so that they're found without locking          
+   static constexpr Count GeneratedSlots = 9;
+   ::std::atomic<Count> mGenerated[GeneratedSlots] {};
+   mutable ::std::recursive_mutex mGenerateMutex;
+
+   // Number of pins, the data isn't evicted while there are any        
+   mutable ::std::atomic<Count> mReaders {};
 };
+
+/// Commit data to the mesh, or collect it, if generators are running         
+/// concurrently on this thread - see Mesh::GenerateAll. Every single index   
+/// buffer goes through here, and is committed as 16-bit if it fits           
+///   @tparam T - the trait to commit the data as                             
+///   @param data - the data to commit                                        
+template<CT::Trait T, class D>
+void Mesh::Commit(D&& data) {
+   using Data = ::std::remove_cvref_t<D>;
+   if constexpr (CT::Exact<T, Traits::Index>
+   and not CT::Trait<Data> and not CT::Exact<Data, Many>) {
+      Many indices {Forward<D>(data)};
+      NarrowIndices(indices);
+      Commit<T>(::std::move(indices));
+   }
+   else if (IsStaging()) {
+      StageData(MetaOf<T>(), [](Mesh* mesh, const Many& staged) {
+         mesh->A::Mesh::template Commit<T>(Many {staged});
+      }, Many {Forward<D>(data)});
+   }
+   else A::Mesh::template Commit<T>(Forward<D>(data));
+}
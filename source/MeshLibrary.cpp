@@ -6,12 +6,17 @@
 /// SPDX-License-Identifier: GPL-3.0-or-later                                 
 ///                                                                           
 #include "MeshLibrary.hpp"
+#include <algorithm>
+#include <vector>
 
 LANGULUS_DEFINE_MODULE(
    MeshLibrary, 9, "AssetsGeometry",
    "Mesh reader, writer and generator", "",
    MeshLibrary, Mesh,
-   Traits::Tesselation
+   Traits::Tesselation, Traits::Weld, Traits::Optimize,
+   Traits::Meshlets, Traits::Simplify, Traits::Budget, Traits::Async,
+   Traits::Progressive, Traits::Interleave, Traits::Quantize,
+   Traits::Bounds, Traits::Bvh, Traits::Evictable
 )
 
 
@@ -30,6 +35,9 @@ MeshLibrary::MeshLibrary(Runtime* runtime, const Many& desc)
 
    RegisterMeshes();
 
+   // Extract the memory budget for generated data, if any              
+   desc.ExtractTrait<Traits::Budget>(mBudget);
+
    // Extract mesh folder, if any                                       
    Path repo = "assets/meshes";
    if (not desc.ExtractTrait<Traits::Name, Traits::Path>(repo))
@@ -53,46 +61,252 @@ MeshLibrary::MeshLibrary(Runtime* runtime, const Many& desc)
 
 /// First stage destruction                                                   
 void MeshLibrary::Teardown() {
+   // Meshes might still be loading in the background                   
+   mWorkers.Stop();
    mFolder.Reset();
+   mStreams.Reset();
    mMeshes.Teardown();
 }
 
-/// Create/destroy meshes                                                     
+/// Get the generated data shared between meshes                              
+///   @return the stream cache                                                
+auto MeshLibrary::GetStreams() -> StreamCache& {
+   return mStreams;
+}
+
+/// Get the threads that load meshes in the background                        
+///   @return the workers                                                     
+auto MeshLibrary::GetWorkers() -> Workers& {
+   return mWorkers;
+}
+
+/// Get a new timestamp, for tracking the least recently used meshes          
+///   @return the timestamp                                                   
+auto MeshLibrary::NextUse() -> uint64_t {
+   return ++mUses;
+}
+
+/// Start tracking a mesh, that can regenerate its data                       
+///   @param mesh - the mesh                                                  
+void MeshLibrary::Track(Mesh* mesh) {
+   ::std::lock_guard lock {mTrackedMutex};
+   mTracked << mesh;
+}
+
+/// Stop tracking a mesh, when it is destroyed                                
+///   @param mesh - the mesh                                                  
+void MeshLibrary::Untrack(Mesh* mesh) {
+   ::std::lock_guard lock {mTrackedMutex};
+   for (Offset i = 0; i < mTracked.GetCount(); ++i) {
+      if (mTracked[i] == mesh) {
+         mTracked.RemoveIndex(i);
+         return;
+      }
+   }
+}
+
+/// Evict the data of the least recently used generated meshes, until the     
+/// data of all generated meshes fits in the memory budget. Evicted meshes    
+/// regenerate their data lazily, the next time it is requested. Data lists   
+/// that are shared between meshes are freed only when all of them have       
+/// been evicted, so they're accounted for only once. Only meshes made with   
+/// Traits::Evictable are evicted, the rest count towards the budget, but     
+/// keep their data. Meshes that are being read at the time are skipped -     
+/// see Mesh::Pin                                                             
+void MeshLibrary::RequestGarbageCollection() {
+   ::std::lock_guard lock {mTrackedMutex};
+
+   // Shared data that no mesh uses anymore can go right away           
+   Count evicted = mStreams.Prune();
+
+   // Find every data list once, along with how many meshes hold it     
+   struct Block {
+      Count mBytes;
+      Count mHolders;
+   };
+
+   TUnorderedMap<const void*, Block> blocks;
+   Count resident = 0;
+   for (auto mesh : mTracked) {
+      for (auto& data : mesh->GetDataLists()) {
+         auto found = blocks.FindIt(data.mRaw);
+         if (found)
+            ++found.GetValue().mHolders;
+         else {
+            blocks.Insert(data.mRaw, Block {data.mBytes, 1});
+            resident += data.mBytes;
+         }
+      }
+   }
+
+   if (resident > mBudget) {
+      // The shared data is only a shortcut for generating it again,    
+      // and it would keep evicted data alive, so it goes first         
+      mStreams.Reset();
+
+      ::std::sort(mTracked.GetRaw(), mTracked.GetRawEnd(),
+         [](const Mesh* a, const Mesh* b) {
+            return a->GetLastUse() < b->GetLastUse();
+         });
+
+      for (auto mesh : mTracked) {
+         if (resident <= mBudget)
+            break;
+
+         const auto lists = mesh->GetDataLists();
+         if (lists.IsEmpty() or not mesh->Evict())
+            continue;
+
+         // Lists committed since they were counted aren't accounted for
+         for (auto& data : lists) {
+            auto found = blocks.FindIt(data.mRaw);
+            if (not found)
+               continue;
+
+            auto& block = found.GetValue();
+            if (--block.mHolders == 0) {
+               resident -= block.mBytes;
+               evicted += block.mBytes;
+            }
+         }
+      }
+   }
+
+   mBytesResident = resident;
+   mBytesEvicted += evicted;
+   Logger::Verbose(Self(), "Generated data: ", resident, " bytes resident, ",
+      evicted, " bytes evicted (", mBytesEvicted.load(), " total)");
+}
+
+/// Get the bytes held by generated meshes, as of the last collection         
+///   @return the number of bytes                                             
+auto MeshLibrary::GetBytesResident() const -> Count {
+   return mBytesResident;
+}
+
+/// Get the bytes of generated data evicted by all collections so far         
+///   @return the number of bytes                                             
+auto MeshLibrary::GetBytesEvicted() const -> Count {
+   return mBytesEvicted;
+}
+
+/// Meshes that are loaded in parallel, while a batch is created on this      
+/// thread. Meshes made on other threads at the same time, like levels of     
+/// detail requested by the workers, aren't part of the batch                 
+static thread_local TMany<const Mesh*>* Batch = nullptr;
+
+/// Wait for the files of a batch to load, so that the created meshes are     
+/// ready, as if they were loaded one after another                           
+///   @param loads - the meshes to wait for                                   
+///   @param previous - the batch to continue, if batches were nested         
+static void FinishBatch(const TMany<const Mesh*>& loads, TMany<const Mesh*>* previous) {
+   Batch = previous;
+   for (auto mesh : loads)
+      mesh->Wait();
+}
+
+/// Create/destroy meshes. A single verb can carry many mesh requests, that   
+/// are resolved as a batch - descriptors are autocompleted in one pass,      
+/// requests are made grouped by their generator, identical requests produce  
+/// the mesh only once, and files are loaded in parallel by the workers,      
+/// instead of one after another. Outputs are in the order of the requests    
 ///   @param verb - the creation/destruction verb                             
 void MeshLibrary::Create(Verb& verb) {
-   Construct request;
+   TMany<Construct> requests;
    verb.ForEachDeep(
       [&](const Construct& construct) {
          // For each construct...                                       
-         if (not construct.CastsTo<A::Mesh>())
-            return;
-         request = construct;
+         if (construct.CastsTo<A::Mesh>())
+            requests << construct;
       },
       [&](const DMeta& type) {
          // For each type...                                            
-         if (not type or not type->CastsTo<A::Mesh>())
-            return;
-         request = Construct {type};
+         if (type and type->CastsTo<A::Mesh>())
+            requests << Construct {type};
       }
    );
 
-   if (request.IsUntyped())
+   if (requests.IsEmpty())
       return;
 
    // Mesh descriptor might be partial, so we attempt to autocomplete it
    // with default traits, provided by the desired generator. This      
    // ensures, that partial requests can match other partial requests,  
    // if they end up the same after the implicit traits are considered  
-   // It's like an additional level of normalization over Neat          
-   if (Mesh::AutocompleteDescriptor(request)) {
-      VERBOSE_MESHES("Mesh autocompleted to: ", request);
-      auto local = verb.Fork(&request);
-      mMeshes.Create(this, local);
-      verb << Abandon(local.GetOutput());
+   // It's like an additional level of normalization over Neat. The     
+   // requests that can't be normalized more probably contain a         
+   // filename, or raw data                                             
+   TMany<DMeta> primitives;
+   TMany<DMeta> kinds;
+   Count files = 0;
+   for (auto& request : requests) {
+      if (Mesh::AutocompleteDescriptor(request)) {
+         VERBOSE_MESHES("Mesh autocompleted to: ", request);
+         const auto primitive = request->FindType<A::Primitive>();
+         if (::std::find(kinds.begin(), kinds.end(), primitive) == kinds.end())
+            kinds << primitive;
+         primitives << primitive;
+      }
+      else {
+         primitives << DMeta {};
+         ++files;
+      }
+   }
+
+   // Requests are made grouped by generator - files first, so that     
+   // their loading starts as early as possible, and then the meshes of 
+   // each primitive one after another                                  
+   TMany<Offset> order;
+   order.Reserve(requests.GetCount());
+   for (Offset i = 0; i < requests.GetCount(); ++i) {
+      if (not primitives[i])
+         order << i;
    }
-   else {
-      // Couldn't be normalized more, but we can still attempt to make  
-      // the mesh, it probably contains a filename, or raw data         
-      mMeshes.Create(this, verb);
+
+   for (auto kind : kinds) {
+      for (Offset i = 0; i < requests.GetCount(); ++i) {
+         if (primitives[i] == kind)
+            order << i;
+      }
    }
+
+   // Files of a batch are loaded in parallel, and waited for at the end
+   // Nested batches don't wait for the meshes of the outer one         
+   TMany<const Mesh*> loads;
+   const auto previous = Batch;
+   Batch = files > 1 ? &loads : nullptr;
+
+   TUnorderedMap<Construct, Offset> unique;
+   ::std::vector<Many> outputs(requests.GetCount());
+   try {
+      for (auto i : order) {
+         auto& request = requests[i];
+         const auto found = unique.FindIt(request);
+         if (found) {
+            // Identical to an earlier request in the same batch        
+            outputs[i] = outputs[found.GetValue()];
+            continue;
+         }
+
+         auto local = verb.Fork(&request);
+         mMeshes.Create(this, local);
+         unique.Insert(request, i);
+         outputs[i] = Move(local.GetOutput());
+      }
+   }
+   catch (...) {
+      FinishBatch(loads, previous);
+      throw;
+   }
+
+   FinishBatch(loads, previous);
+   for (auto& output : outputs)
+      verb << Abandon(output);
+}
+
+/// Get the meshes that are loaded in parallel, while a batch is created      
+/// on the calling thread                                                     
+///   @return the meshes to wait for, or nullptr if not creating a batch      
+auto MeshLibrary::GetBatch() -> TMany<const Mesh*>* {
+   return Batch;
 }
\ No newline at end of file
@@ -7,7 +7,10 @@
 ///                                                                           
 #pragma once
 #include "Mesh.hpp"
+#include "Streams.hpp"
+#include "Workers.hpp"
 #include <Langulus/Flow/Factory.hpp>
+#include <atomic>
 
 
 ///                                                                           
@@ -22,11 +25,37 @@ private:
    // Mesh library                                                      
    TFactoryUnique<::Mesh> mMeshes;
 
+   // Generated data, shared between meshes                             
+   StreamCache mStreams;
+
+   // Threads for loading meshes in the background                      
+   Workers mWorkers;
+
+   // Meshes that can regenerate their data, so it can be evicted       
+   ::std::mutex mTrackedMutex;
+   TMany<Mesh*> mTracked;
+   ::std::atomic<uint64_t> mUses {};
+
+   // Memory budget for the data of generated meshes, in bytes          
+   Count mBudget = 256 * 1024 * 1024;
+   ::std::atomic<Count> mBytesResident {};
+   ::std::atomic<Count> mBytesEvicted {};
+
 public:
    MeshLibrary(Runtime*, const Many&);
 
    void Create(Verb&);
    void Teardown();
-   void RequestGarbageCollection() {}
+   void RequestGarbageCollection();
+
+   auto GetStreams() -> StreamCache&;
+   auto GetWorkers() -> Workers&;
+   auto GetBatch() -> TMany<const Mesh*>*;
+   auto NextUse() -> uint64_t;
+   void Track(Mesh*);
+   void Untrack(Mesh*);
+
+   auto GetBytesResident() const -> Count;
+   auto GetBytesEvicted() const -> Count;
 };
 
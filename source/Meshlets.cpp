@@ -0,0 +1,234 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Meshlets.hpp"
+#include "Mesh.hpp"
+#include <algorithm>
+#include <cmath>
+
+
+namespace Meshlets {
+
+   /// Marks a mesh vertex that isn't in the current meshlet                  
+   constexpr uint8_t Unused = 0xFF;
+   static_assert(Meshlet::MaxVertices < Unused);
+
+   inline float Dot(const Vec3f& a, const Vec3f& b) noexcept {
+      return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+   }
+
+   inline Vec3f Cross(const Vec3f& a, const Vec3f& b) noexcept {
+      return {
+         a[1] * b[2] - a[2] * b[1],
+         a[2] * b[0] - a[0] * b[2],
+         a[0] * b[1] - a[1] * b[0]
+      };
+   }
+
+   inline Vec3f Sub(const Vec3f& a, const Vec3f& b) noexcept {
+      return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+   }
+
+   void Bound(Meshlet&, const TMany<Vec3f>&, const TMany<uint32_t>&, const TMany<uint8_t>&);
+
+} // namespace Meshlets
+
+
+/// Calculate the bounding sphere and normal cone of a meshlet                
+/// The cone follows the same conventions as meshoptimizer's cluster bounds   
+///   @param meshlet - [in/out] the meshlet to bound                          
+///   @param positions - mesh positions                                       
+///   @param vertices - meshlet vertices                                      
+///   @param triangles - meshlet triangles                                    
+void Meshlets::Bound(
+   Meshlet& meshlet, const TMany<Vec3f>& positions,
+   const TMany<uint32_t>& vertices, const TMany<uint8_t>& triangles
+) {
+   const auto vertex = [&](uint8_t local) -> const Vec3f& {
+      return positions[vertices[meshlet.mVertexOffset + local]];
+   };
+
+   // Sphere around the center of the bounding box                      
+   Vec3f min = vertex(0);
+   Vec3f max = vertex(0);
+   for (uint32_t i = 1; i < meshlet.mVertexCount; ++i) {
+      const auto& p = vertex(static_cast<uint8_t>(i));
+      for (int a = 0; a < 3; ++a) {
+         min[a] = ::std::min(min[a], p[a]);
+         max[a] = ::std::max(max[a], p[a]);
+      }
+   }
+
+   meshlet.mCenter = Vec3f {
+      (min[0] + max[0]) * 0.5f,
+      (min[1] + max[1]) * 0.5f,
+      (min[2] + max[2]) * 0.5f
+   };
+
+   float radius = 0;
+   for (uint32_t i = 0; i < meshlet.mVertexCount; ++i) {
+      const auto d = Sub(vertex(static_cast<uint8_t>(i)), meshlet.mCenter);
+      radius = ::std::max(radius, Dot(d, d));
+   }
+   meshlet.mRadius = ::std::sqrt(radius);
+
+   // Normal cone, around the average of the triangle normals           
+   Vec3f normals[Meshlet::MaxTriangles];
+   Vec3f axis {0, 0, 0};
+   uint32_t count = 0;
+   const auto first = triangles.GetRaw() + meshlet.mTriangleOffset;
+   for (uint32_t t = 0; t < meshlet.mTriangleCount; ++t) {
+      const auto& a = vertex(first[t * 3 + 0]);
+      const auto& b = vertex(first[t * 3 + 1]);
+      const auto& c = vertex(first[t * 3 + 2]);
+      auto n = Cross(Sub(b, a), Sub(c, a));
+      const auto length = ::std::sqrt(Dot(n, n));
+      if (length <= 0)
+         continue;
+
+      n = Vec3f {n[0] / length, n[1] / length, n[2] / length};
+      axis = Vec3f {axis[0] + n[0], axis[1] + n[1], axis[2] + n[2]};
+      normals[count++] = n;
+   }
+
+   meshlet.mConeApex = meshlet.mCenter;
+   meshlet.mConeAxis = Vec3f {0, 0, 0};
+   meshlet.mConeCutoff = 1;
+
+   const auto length = ::std::sqrt(Dot(axis, axis));
+   if (not count or length <= 0)
+      return;
+   axis = Vec3f {axis[0] / length, axis[1] / length, axis[2] / length};
+
+   float spread = 1;
+   for (uint32_t t = 0; t < count; ++t)
+      spread = ::std::min(spread, Dot(normals[t], axis));
+
+   // The cone is too wide to ever cull anything                        
+   if (spread <= 0.1f)
+      return;
+
+   // Move the apex back along the axis, until all triangle planes are  
+   // in front of it                                                    
+   float distance = 0;
+   for (uint32_t t = 0, n = 0; t < meshlet.mTriangleCount; ++t) {
+      const auto& a = vertex(first[t * 3 + 0]);
+      const auto& b = vertex(first[t * 3 + 1]);
+      const auto& c = vertex(first[t * 3 + 2]);
+      const auto e = Cross(Sub(b, a), Sub(c, a));
+      if (Dot(e, e) <= 0)
+         continue;
+
+      const auto& normal = normals[n++];
+      distance = ::std::max(distance,
+         Dot(Sub(meshlet.mCenter, a), normal) / Dot(axis, normal));
+   }
+
+   meshlet.mConeApex = Vec3f {
+      meshlet.mCenter[0] - axis[0] * distance,
+      meshlet.mCenter[1] - axis[1] * distance,
+      meshlet.mCenter[2] - axis[2] * distance
+   };
+   meshlet.mConeAxis = axis;
+   meshlet.mConeCutoff = ::std::sqrt(1 - spread * spread);
+}
+
+/// Partition the triangle list into meshlets, by adding triangles in the     
+/// order they're indexed, until either limit is reached. Run the vertex      
+/// cache optimization first, for fewer and tighter meshlets                  
+///   @param model - the mesh to build meshlets for                           
+void Mesh::GenerateMeshlets(Mesh* model) {
+   using namespace Meshlets;
+
+   // Meshlets are built from other streams, that might be generated    
+   model->Generate(MetaOf<Traits::Index>());
+   model->Generate(MetaOf<Traits::Place>());
+
+   const auto topology = model->mView.mTopology;
+   if (not topology
+   or topology->CastsTo<A::TriangleStrip>()
+   or not topology->CastsTo<A::Triangle>())
+      return;
+
+   // Meshes indexed separately for each attribute must be welded first 
+   if (model->GetData<Traits::Index>(1))
+      return;
+
+   const auto indices = model->GatherIndices();
+   const auto positions = model->GatherPositions();
+   if (indices.GetCount() < 3 or positions.IsEmpty())
+      return;
+
+   const auto triangleCount = indices.GetCount() / 3;
+   TMany<uint8_t> local;
+   local.Reserve<true>(positions.GetCount());
+   for (auto& l : local)
+      l = Unused;
+
+   TMany<Meshlet>  meshlets;
+   TMany<uint32_t> vertices;
+   TMany<uint8_t>  triangles;
+   meshlets.Reserve(triangleCount / Meshlet::MaxTriangles + 1);
+   vertices.Reserve(positions.GetCount());
+   triangles.Reserve(triangleCount * 3);
+
+   Meshlet current;
+   const auto flush = [&] {
+      if (not current.mTriangleCount)
+         return;
+
+      for (uint32_t i = 0; i < current.mVertexCount; ++i)
+         local[vertices[current.mVertexOffset + i]] = Unused;
+
+      Bound(current, positions, vertices, triangles);
+      meshlets << current;
+
+      current = {};
+      current.mVertexOffset = static_cast<uint32_t>(vertices.GetCount());
+      current.mTriangleOffset = static_cast<uint32_t>(triangles.GetCount());
+   };
+
+   for (Offset t = 0; t < triangleCount; ++t) {
+      const uint32_t v[3] {
+         indices[t * 3 + 0],
+         indices[t * 3 + 1],
+         indices[t * 3 + 2]
+      };
+
+      if (v[0] >= positions.GetCount()
+      or  v[1] >= positions.GetCount()
+      or  v[2] >= positions.GetCount())
+         continue;
+
+      const Count added = (local[v[0]] == Unused)
+         + (local[v[1]] == Unused and v[1] != v[0])
+         + (local[v[2]] == Unused and v[2] != v[0] and v[2] != v[1]);
+
+      if (current.mVertexCount + added > Meshlet::MaxVertices
+      or  current.mTriangleCount + 1 > Meshlet::MaxTriangles)
+         flush();
+
+      for (auto i : v) {
+         if (local[i] == Unused) {
+            local[i] = static_cast<uint8_t>(current.mVertexCount++);
+            vertices << i;
+         }
+
+         triangles << local[i];
+      }
+
+      ++current.mTriangleCount;
+   }
+
+   flush();
+
+   VERBOSE_MESHES("Built ", meshlets.GetCount(), " meshlets from ",
+      triangleCount, " triangles");
+   model->Commit<Traits::Meshlets>(Abandon(meshlets));
+   model->Commit<Traits::Meshlets>(Abandon(vertices));
+   model->Commit<Traits::Meshlets>(Abandon(triangles));
+}
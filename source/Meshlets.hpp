@@ -0,0 +1,45 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+
+
+///                                                                           
+///   A meshlet                                                               
+///                                                                           
+/// A cluster of neighbouring triangles, small enough to be processed by a    
+/// single mesh shader workgroup, or to be culled as a whole. Meshlets are    
+/// committed as three data lists under Traits::Meshlets:                     
+///   0 - the meshlets themselves                                             
+///   1 - meshlet vertices, each being an uint32_t index of a mesh vertex     
+///   2 - meshlet triangles, each being three uint8_t indices of meshlet      
+///       vertices, relative to the meshlet's mVertexOffset                   
+///                                                                           
+struct Meshlet {
+   LANGULUS(NAME) "Meshlet";
+   LANGULUS(POD) true;
+
+   // Limits that fit most mesh shader implementations                  
+   static constexpr Count MaxVertices = 64;
+   static constexpr Count MaxTriangles = 124;
+
+   uint32_t mVertexOffset = 0;   // First of the meshlet vertices       
+   uint32_t mTriangleOffset = 0; // First of the meshlet triangle indices
+   uint32_t mVertexCount = 0;
+   uint32_t mTriangleCount = 0;
+
+   // Bounding sphere                                                   
+   Vec3f mCenter;
+   float mRadius = 0;
+
+   // Normal cone - all triangles are backfacing when viewed from P, if 
+   // dot(normalize(mConeApex - P), mConeAxis) >= mConeCutoff           
+   Vec3f mConeApex;
+   Vec3f mConeAxis;
+   float mConeCutoff = 1;
+};
@@ -5,176 +5,66 @@
 ///                                                                           
 /// SPDX-License-Identifier: GPL-3.0-or-later                                 
 ///                                                                           
-#include "Mesh.hpp"
-#include <Langulus/IO.hpp>
-#include <Langulus/Flow/Time.hpp>
-
-
-///                                                                           
-///   An *.OBJ file representation and interface                              
-///                                                                           
-/// Based on fast_obj v1.2 https://github.com/thisistherk/fast_obj            
-/// Completely rewritten to use Langulus containers and C++20                 
-/// TODO test if actually faster and contribute back if so                    
-///                                                                           
-struct Obj {
-
-   using Idx = unsigned;
-
-   /// Parsed texture descriptor                                              
-   struct Texture {
-      Text name;                 // Texture name from .mtl file         
-   };
-
-   /// Parsed material descriptor                                             
-   struct Material {
-      Text name;                 // Material name                       
-
-      float Ka[3] = {0, 0, 0};   // Ambient                             
-      float Kd[3] = {1, 1, 1};   // Diffuse                             
-      float Ks[3] = {0, 0, 0};   // Specular                            
-      float Ke[3] = {0, 0, 0};   // Emission                            
-      float Kt[3] = {0, 0, 0};   // Transmittance                       
-      float Ns = 1;              // Shininess                           
-      float Ni = 1;              // Index of refraction                 
-      float Tf[3] = {1, 1, 1};   // Transmission filter                 
-      float d = 1;               // Disolve (alpha)                     
-      int   illum = 1;           // Illumination model                  
-
-      // Set for materials that don't come from the associated mtllib   
-      int   fallback = 0;
-
-      // Texture maps                                                   
-      Texture map_Ka;
-      Texture map_Kd;
-      Texture map_Ks;
-      Texture map_Ke;
-      Texture map_Kt;
-      Texture map_Ns;
-      Texture map_Ni;
-      Texture map_d;
-      Texture map_bump;
-   };
-
-   /// Parsed object group                                                    
-   struct Group {
-      Text name;                 // Group name                          
-      Offset face_count = 0;     // Number of faces                     
-      Offset face_offset = 0;    // First face in fastObjMesh face_* arrays
-      Offset index_offset = 0;   // First index in fastObjMesh indices array
-   };
-
-   /// Parsed object mesh                                                     
-   struct Mesh {
-      // Vertex data                                                    
-      TMany<Vec3f> positions;
-      TMany<Vec2f> texcoords;
-      TMany<Vec3f> normals;
-      TMany<Vec3f> colors;
-
-      // Face data: one element for each face                           
-      Count          face_count;
-      TMany<Offset>  face_vertices;
-      TMany<Offset>  face_materials;
-
-      // Indices for each vertex attribute                              
-      TMany<Idx>   mPositionIndices;
-      TMany<Idx>   mTextureIndices;
-      TMany<Idx>   mNormalIndices;
-
-      // Materials                                                      
-      TMany<Material> materials;
-
-      // Mesh objects ('o' tag in .obj file)                            
-      TMany<Group>    objects;
-
-      // Mesh groups ('g' tag in .obj file)                             
-      TMany<Group>    groups;
-   };
-
-
-   struct Data {
-      // Final mesh                                                     
-      Mesh* mesh;
-
-      // Current object/group                                           
-      Group object;
-      Group group;
-
-      // Current material index                                         
-      Offset material;
-
-      // Current line in file                                           
-      Offset line;
-   };
-
-   // Size of buffer to read into                                       
-   static constexpr size_t BufferSize = 65536;
-
-   // Max supported power when parsing float                            
-   static constexpr size_t MAX_POWER = 20;
-   
-   static constexpr double POWER_10_POS[MAX_POWER] = {
-       1.0e0,  1.0e1,  1.0e2,  1.0e3,  1.0e4,  1.0e5,  1.0e6,  1.0e7,  1.0e8,  1.0e9,
-       1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16, 1.0e17, 1.0e18, 1.0e19,
-   };
+#include "OBJ.hpp"
+#include "Scanner.hpp"
+#include <thread>
+
+
+/// Parse the whole file over a single contiguous view of its contents.       
+/// This avoids the chunk-boundary bookkeeping and the copying of leftover    
+/// lines that read_chunked has to do, and allows for parallel parsing        
+///   @param out - [out] the parsed mesh                                      
+///   @param file - the file to parse                                         
+///   @param workers - the threads to parse on, along with the calling one    
+///   @param step - bytes to parse between publishing the data parsed so      
+///      far, or zero to parse the whole file in parallel instead             
+///   @param publish - receives the data parsed so far                        
+///   @return false if the file system couldn't provide a contiguous view,    
+///           in which case nothing was parsed and read_chunked should be used
+bool Obj::read_view(
+   Mesh& out, const A::File& file, Workers& workers,
+   size_t step, const Publish& publish
+) {
+   // The file system module must know the size of the file in          
+   // advance, so that contents can be acquired in a single read        
+   const auto size = file.GetBytesize();
+   if (size == 0)
+      return false;
 
-   static constexpr double POWER_10_NEG[MAX_POWER] = {
-       1.0e0,   1.0e-1,  1.0e-2,  1.0e-3,  1.0e-4,  1.0e-5,  1.0e-6,  1.0e-7,  1.0e-8,  1.0e-9,
-       1.0e-10, 1.0e-11, 1.0e-12, 1.0e-13, 1.0e-14, 1.0e-15, 1.0e-16, 1.0e-17, 1.0e-18, 1.0e-19,
-   };
+   auto contents = file.ReadAs<Text>();
+   if (contents.GetCount() != size)
+      return false;
+
+   // Ensure buffer ends in a newline                                   
+   if (*(contents.GetRawEnd() - 1) != '\n')
+      contents << '\n';
+   pad(contents);
+
+   if (step)
+      parse_progressive(out, contents.GetRaw(), contents.GetRawEnd(), file, workers, step, publish);
+   else
+      parse_parallel(out, contents.GetRaw(), contents.GetRawEnd(), &file, workers, 0);
+   return true;
+}
 
-   static int is_whitespace(char c);
-   static int is_newline(char c);
-   static int is_digit(char c);
-   static int is_exponent(char c);
-   static const char* skip_name(const char* ptr);
-   static const char* skip_whitespace(const char* ptr);
-   static const char* skip_line(const char* ptr);
-   static void flush_object(Data* data);
-   static void flush_group(Data* data);
-   static const char* parse_int(const char* ptr, int* val);
-   static const char* parse_float(const char* ptr, float* val);
-   static const char* parse_vertex(Data* data, const char* ptr);
-   static const char* parse_texcoord(Data* data, const char* ptr);
-   static const char* parse_normal(Data* data, const char* ptr);
-   static const char* parse_face(Data* data, const char* ptr);
-   static const char* parse_object(Data* data, const char* ptr);
-   static const char* parse_group(Data* data, const char* ptr);
-   static const char* parse_usemtl(Data* data, const char* ptr);
-   static const char* read_mtl_int(const char* p, int* v);
-   static const char* read_mtl_single(const char* p, float* v);
-   static const char* read_mtl_triple(const char* p, float v[3]);
-   static const char* read_map(Data* data, const char* ptr, Texture* map);
-   static int read_mtllib(Data* data, const A::File& file);
-   static void parse_buffer(Data* data, const char* ptr, const char* end, Ref<A::File::Reader>& stream);
-};
-
-
-/// Load OBJ file                                                             
-///   @param file - [in/out] the file to load from                            
-///   @return true if model was loaded without any problems                   
-bool Mesh::ReadOBJ(const A::File& file) {
-   auto loadTime = SteadyClock::Now();
+/// Parse the file by streaming it through a fixed-size buffer. This is the   
+/// fallback for file system backends, that can't provide a contiguous view   
+///   @param out - [out] the parsed mesh                                      
+///   @param file - the file to parse                                         
+void Obj::read_chunked(Mesh& out, const A::File& file) {
    auto stream = file.NewReader();
 
-   // Empty mesh                                                        
-   Obj::Mesh m;
-
-   // Add dummy position/texcoord/normal                                
-   m.positions << 0;
-   m.texcoords << 0;
-   m.normals   << Vec3f {0, 0, 1};
-
-   // Data needed during parsing                                        
-   Obj::Data data;
-   data.mesh = &m;
-   data.material = 0;
-   data.line = 1;
+   // The whole file is a single chunk, and material libraries are      
+   // loaded as they are encountered                                    
+   Mesh local;
+   Data data;
+   begin_chunk(&data, &local, &out.materials, true);
+   data.file = &file;
 
    // Create buffer for reading file                                    
    Text buffer;
-   buffer.Reserve<true>(2 * Obj::BufferSize);
+   buffer.Reserve<true>(2 * BufferSize);
+   pad(buffer);
    auto start = buffer.GetRaw();
 
    for (;;) {
@@ -184,7 +74,7 @@ bool Mesh::ReadOBJ(const A::File& file) {
          break;
 
       // Ensure buffer ends in a newline                                
-      if (read < Obj::BufferSize) {
+      if (read < BufferSize) {
          if (read == 0 or start[read - 1] != '\n')
             start[read++] = '\n';
       }
@@ -208,7 +98,7 @@ bool Mesh::ReadOBJ(const A::File& file) {
       last++;
 
       // Process buffer                                                 
-      Obj::parse_buffer(&data, buffer.GetRaw(), last, stream);
+      parse_buffer(&data, buffer.GetRaw(), last);
 
       // Copy overflow for next buffer                                  
       auto bytes = end - last;
@@ -216,40 +106,407 @@ bool Mesh::ReadOBJ(const A::File& file) {
       start = buffer.GetRaw() + bytes;
    }
 
-   // Flush final object/group                                          
-   mView.mPrimitiveCount = static_cast<uint32_t>(m.face_vertices.GetCount());
-   mView.mIndexCount = static_cast<uint32_t>(m.mPositionIndices.GetCount());
-   mView.mTextureMapping = m.texcoords.IsEmpty()
-      ? Math::MapModeType::Model
-      : Math::MapModeType::Custom;
-   mView.mTopology = MetaDataOf<A::Triangle>();
-
-   /*m.material_count = m.materials.GetCount();
-   m.object_count = m.objects.GetCount();
-   m.group_count = m.groups.GetCount();*/
-
-   // Save the contents                                                 
-   Commit<Traits::Place>   (Move(m.positions));
-   Commit<Traits::Aim>     (Move(m.normals));
-   Commit<Traits::Sampler> (Move(m.texcoords));
-   Commit<Traits::Color>   (Move(m.colors));
-   Commit<Traits::Index>   (Traits::Place   {Move(m.mPositionIndices)});
-   Commit<Traits::Index>   (Traits::Aim     {Move(m.mNormalIndices)});
-   Commit<Traits::Index>   (Traits::Sampler {Move(m.mTextureIndices)});
-
-   Logger::Verbose(Logger::Green, "File ", file.GetFilePath(), 
-      " loaded in ", SteadyClock::Now() - loadTime);
-   return true;
+   Merge state;
+   merge_chunk(out, state, data);
+   finish_merge(out, state);
+}
+
+/// Split a newline-terminated buffer into chunks at line boundaries, parse   
+/// them concurrently, each into its own mesh, and then merge the results in  
+/// order. Vertex attributes are counted in a quick first pass, so that every 
+/// chunk can resolve relative face indices on its own                        
+///   @param out - [out] the parsed mesh                                      
+///   @param ptr - start of the buffer                                        
+///   @param end - end of the buffer, must be right after a newline           
+///   @param file - the file being parsed, used to locate material libraries, 
+///      or nullptr to not load any                                           
+///   @param workers - the threads to parse on, along with the calling one    
+///   @param count - number of chunks, or zero to pick one for each thread    
+void Obj::parse_parallel(
+   Mesh& out, const char* ptr, const char* end, const A::File* file,
+   Workers& workers, size_t count
+) {
+   auto chunks = split(ptr, end, count);
+
+   // Count vertex attributes and lines, and gather material libraries  
+   workers.ForEach(chunks.size(), [&](Offset i) {
+      count_buffer(&chunks[i]);
+   });
+
+   // Material libraries are loaded before parsing, because chunks      
+   // only look materials up, and never load them on their own          
+   for (auto& chunk : chunks) {
+      for (auto& lib : chunk.libraries) {
+         if (not file)
+            break;
+
+         auto mtl = file->RelativeFile(lib);
+         if (mtl)
+            read_mtllib(&out.materials, *mtl);
+      }
+   }
+
+   // Calculate where each chunk's vertex attributes and lines begin    
+   Count positions = 0;
+   Count texcoords = 0;
+   Count normals = 0;
+   Count faces = 0;
+   Count lines = 0;
+   for (size_t i = 0; i < chunks.size(); ++i) {
+      auto& chunk = chunks[i];
+      begin_chunk(&chunk.data, &chunk.mesh, &out.materials, i == 0);
+      chunk.data.position_base = positions;
+      chunk.data.texcoord_base = texcoords;
+      chunk.data.normal_base = normals;
+      chunk.data.line = 1 + lines;
+      lines += chunk.lines;
+
+      positions += chunk.positions + chunk.mesh.positions.GetCount();
+      texcoords += chunk.texcoords + chunk.mesh.texcoords.GetCount();
+      normals   += chunk.normals   + chunk.mesh.normals.GetCount();
+      faces     += chunk.faces;
+
+      if (i > 0)
+         reserve(chunk.mesh, chunk.positions, chunk.texcoords, chunk.normals, chunk.faces);
+   }
+
+   // The first chunk becomes the output, so reserve everything there   
+   reserve(chunks[0].mesh, positions, texcoords, normals, faces);
+
+   // Parse                                                             
+   workers.ForEach(chunks.size(), [&](Offset i) {
+      parse_buffer(&chunks[i].data, chunks[i].begin, chunks[i].end);
+   });
+
+   // Merge in order                                                    
+   Merge state;
+   for (auto& chunk : chunks)
+      merge_chunk(out, state, chunk.data);
+   finish_merge(out, state);
+}
+
+/// Parse a newline-terminated buffer in steps, publishing the data parsed    
+/// after each step, so that it can be drawn before the whole file is done.   
+/// Everything is counted in parallel up front, so that the parsed data is    
+/// reserved once and never moves, and the published data stays valid while   
+/// parsing continues. Steps are parsed one after another, so this trades     
+/// some of the total parsing time for a shorter time to the first step       
+///   @param out - [out] the parsed mesh                                      
+///   @param ptr - start of the buffer                                        
+///   @param end - end of the buffer, must be right after a newline           
+///   @param file - the file being parsed, used to locate material libraries  
+///   @param workers - the threads to count on, along with the calling one    
+///   @param step - bytes to parse between publishing, rounded up to lines    
+///   @param publish - receives the data parsed so far                        
+void Obj::parse_progressive(
+   Mesh& out, const char* ptr, const char* end, const A::File& file,
+   Workers& workers, size_t step, const Publish& publish
+) {
+   auto chunks = split(ptr, end, 0);
+   workers.ForEach(chunks.size(), [&](Offset i) {
+      count_buffer(&chunks[i]);
+   });
+
+   // The whole file is parsed as a single chunk                        
+   Chunk whole;
+   for (auto& chunk : chunks) {
+      whole.positions += chunk.positions;
+      whole.texcoords += chunk.texcoords;
+      whole.normals   += chunk.normals;
+      whole.faces     += chunk.faces;
+
+      for (auto& lib : chunk.libraries) {
+         auto mtl = file.RelativeFile(lib);
+         if (mtl)
+            read_mtllib(&out.materials, *mtl);
+      }
+   }
+
+   begin_chunk(&whole.data, &whole.mesh, &out.materials, true);
+   reserve(whole.mesh,
+      whole.positions + whole.mesh.positions.GetCount(),
+      whole.texcoords + whole.mesh.texcoords.GetCount(),
+      whole.normals   + whole.mesh.normals.GetCount(),
+      whole.faces);
+
+   for (auto begin = ptr; begin != end;) {
+      auto split = static_cast<size_t>(end - begin) > step ? begin + step : end;
+      while (split != end and *(split - 1) != '\n')
+         ++split;
+
+      parse_buffer(&whole.data, begin, split);
+      begin = split;
+      if (begin != end)
+         publish(whole.mesh);
+   }
+
+   Merge state;
+   merge_chunk(out, state, whole.data);
+   finish_merge(out, state);
+}
+
+/// Split a newline-terminated buffer into chunks at line boundaries, one     
+/// for each hardware thread, unless that makes them too small                
+///   @param ptr - start of the buffer                                        
+///   @param end - end of the buffer, must be right after a newline           
+///   @param count - number of chunks, or zero to pick one for each thread    
+///   @return the chunks                                                      
+auto Obj::split(const char* ptr, const char* end, size_t count) -> ::std::vector<Chunk> {
+   const auto size = static_cast<size_t>(end - ptr);
+   size_t workers = count;
+   if (workers == 0) {
+      workers = ::std::thread::hardware_concurrency();
+      if (workers > size / MinChunkSize)
+         workers = size / MinChunkSize;
+      if (workers == 0)
+         workers = 1;
+   }
+
+   // Split the buffer, so that each chunk starts at a new line         
+   ::std::vector<Chunk> chunks(workers);
+   auto begin = ptr;
+   for (size_t i = 0; i < workers; ++i) {
+      auto split = i + 1 == workers ? end : ptr + size * (i + 1) / workers;
+      if (split <= begin)
+         split = begin;
+      else while (split != end and *(split - 1) != '\n')
+         ++split;
+
+      chunks[i].begin = begin;
+      chunks[i].end = split;
+      begin = split;
+   }
+
+   return chunks;
+}
+
+/// Count the vertex attributes, triangles and lines in a chunk, and gather   
+/// its material libraries. Polygons are counted as the triangles they'll be  
+/// split into, so that reserving is exact                                    
+///   @param chunk - [in/out] the chunk to scan                               
+void Obj::count_buffer(Chunk* chunk) {
+   for (auto p = chunk->begin; p != chunk->end; p = skip_line(p)) {
+      ++chunk->lines;
+      p = skip_whitespace(p);
+
+      switch (*p) {
+      case 'v':
+         if (p[1] == ' ' or p[1] == '\t')
+            ++chunk->positions;
+         else if (p[1] == 't')
+            ++chunk->texcoords;
+         else if (p[1] == 'n')
+            ++chunk->normals;
+         break;
+
+      case 'f':
+         if (p[1] == ' ' or p[1] == '\t') {
+            Count corners = 0;
+            for (auto c = skip_whitespace(p + 1); not is_newline(*c); c = skip_whitespace(c)) {
+               ++corners;
+               while (not is_whitespace(*c) and not is_newline(*c))
+                  ++c;
+            }
+
+            if (corners > 2)
+               chunk->faces += corners - 2;
+         }
+         break;
+
+      case 'm':
+         if (Token {p + 1, p + 6} == "tllib" and is_whitespace(p[6])) {
+            auto s = skip_whitespace(p + 6);
+            auto e = skip_name(s);
+            const Path lib = Token {s, e};
+            if (lib)
+               chunk->libraries << lib;
+         }
+         break;
+      }
+   }
+}
+
+/// Prepare the parsing state for a chunk                                     
+///   @param data - [out] the state to prepare                                
+///   @param mesh - the mesh that receives the chunk                          
+///   @param library - the materials loaded from material libraries           
+///   @param first - whether this is the first chunk in the file              
+void Obj::begin_chunk(
+   Data* data, Mesh* mesh, TMany<Material>* library, bool first
+) {
+   data->mesh = mesh;
+   data->library = library;
+   data->file = nullptr;
+   data->line = 1;
+
+   if (first) {
+      // Add dummy position/texcoord/normal                             
+      mesh->positions << 0;
+      mesh->texcoords << 0;
+      mesh->normals   << Vec3f {0, 0, 1};
+      data->material = 0;
+   }
+   else data->material = NoMaterial;
+}
+
+/// Reserve memory for parsing, based on statements counted in advance        
+///   @param mesh - [out] the mesh to reserve in                              
+///   @param positions - number of positions                                  
+///   @param texcoords - number of texture coordinates                        
+///   @param normals - number of normals                                      
+///   @param faces - number of triangles                                      
+void Obj::reserve(
+   Mesh& mesh, Count positions, Count texcoords, Count normals, Count faces
+) {
+   mesh.positions.Reserve(positions);
+   mesh.texcoords.Reserve(texcoords);
+   mesh.normals.Reserve(normals);
+   mesh.face_vertices.Reserve(faces);
+   mesh.face_materials.Reserve(faces);
+   mesh.mPositionIndices.Reserve(faces * 3);
+   mesh.mTextureIndices.Reserve(faces * 3);
+   mesh.mNormalIndices.Reserve(faces * 3);
+}
+
+/// Append the contents of one container to another                           
+///   @param to - [in/out] the container to append to                         
+///   @param from - [in/out] the container to append, might be moved from     
+template<class T>
+void Obj::append(TMany<T>& to, TMany<T>& from) {
+   if (to.IsEmpty()) {
+      to = Move(from);
+      return;
+   }
+
+   to.Reserve(to.GetCount() + from.GetCount());
+   for (auto& item : from)
+      to << item;
+}
+
+/// Merge a parsed chunk into the output mesh. Chunks must be merged in the   
+/// order they appear in the file                                             
+///   @param out - [in/out] the mesh to merge into                            
+///   @param state - [in/out] the object/group/material left open so far      
+///   @param chunk - [in/out] the parsed chunk, its contents are moved from   
+void Obj::merge_chunk(Mesh& out, Merge& state, Data& chunk) {
+   auto& in = *chunk.mesh;
+   const auto faceBase = out.face_vertices.GetCount();
+   const auto indexBase = out.mPositionIndices.GetCount();
+
+   // Fallback materials are matched by name with the ones we have      
+   TMany<Offset> remap;
+   remap.Reserve(in.materials.GetCount());
+   for (auto& mtl : in.materials) {
+      Offset idx = 0;
+      while (idx < out.materials.GetCount()) {
+         if (out.materials[idx].name == mtl.name)
+            break;
+         idx++;
+      }
+
+      if (idx == out.materials.GetCount())
+         out.materials << mtl;
+      remap << idx;
+   }
+
+   const auto resolve = [&](Offset material) -> Offset {
+      if (material == NoMaterial)
+         return state.material;
+      if (material & FallbackMaterial)
+         return remap[material & ~FallbackMaterial];
+      return material;
+   };
+
+   // Colors are optional, so the ones we have might be too short       
+   if (in.colors) {
+      for (auto ii = out.colors.GetCount();
+                ii < out.positions.GetCount(); ++ii)
+         out.colors << 1;
+      append(out.colors, in.colors);
+   }
+
+   // Vertex data. Face indices are already resolved against all        
+   // preceding chunks, so they are appended as they are                
+   append(out.positions, in.positions);
+   append(out.texcoords, in.texcoords);
+   append(out.normals, in.normals);
+   append(out.mPositionIndices, in.mPositionIndices);
+   append(out.mTextureIndices, in.mTextureIndices);
+   append(out.mNormalIndices, in.mNormalIndices);
+   append(out.face_vertices, in.face_vertices);
+
+   for (auto& material : in.face_materials)
+      material = resolve(material);
+   append(out.face_materials, in.face_materials);
+
+   if (chunk.material != NoMaterial)
+      state.material = resolve(chunk.material);
+
+   // Objects and groups                                                
+   merge_groups(out.objects, state.object, in.objects,
+      chunk.lead_object, chunk.leading_object, chunk.object,
+      faceBase, indexBase);
+   merge_groups(out.groups, state.group, in.groups,
+      chunk.lead_group, chunk.leading_group, chunk.group,
+      faceBase, indexBase);
+}
+
+/// Merge the objects/groups of a chunk                                       
+///   @param out - [in/out] the merged objects/groups                         
+///   @param open - [in/out] the object/group left open by previous chunks    
+///   @param in - [in/out] the chunk's flushed objects/groups                 
+///   @param lead - [in/out] the chunk's first object/group, if flushed       
+///   @param leading - whether the chunk never flushed its first one          
+///   @param current - [in/out] the object/group the chunk left open          
+///   @param faceBase - number of faces in all preceding chunks               
+///   @param indexBase - number of indices in all preceding chunks            
+void Obj::merge_groups(
+   TMany<Group>& out, Group& open, TMany<Group>& in, Group& lead,
+   bool leading, Group& current, Count faceBase, Count indexBase
+) {
+   if (leading) {
+      // The whole chunk continues the open object/group                
+      open.face_count += current.face_count;
+      return;
+   }
+
+   open.face_count += lead.face_count;
+   if (open.face_count > 0)
+      out << Move(open);
+
+   for (auto& group : in) {
+      group.face_offset += faceBase;
+      group.index_offset += indexBase;
+      out << Move(group);
+   }
+
+   open = Move(current);
+   open.face_offset += faceBase;
+   open.index_offset += indexBase;
+}
+
+/// Flush the final object/group, after all chunks were merged                
+///   @param out - [in/out] the merged mesh                                   
+///   @param state - [in/out] the object/group left open                      
+void Obj::finish_merge(Mesh& out, Merge& state) {
+   if (state.object.face_count > 0)
+      out.objects << Move(state.object);
+   if (state.group.face_count > 0)
+      out.groups << Move(state.group);
+
+   if (out.colors) {
+      // Fill the remaining slots in the colors array                   
+      for (auto ii = out.colors.GetCount();
+                ii < out.positions.GetCount(); ++ii)
+         out.colors << 1;
+   }
 }
 
 /// Parse a chunk of obj file memory                                          
 ///   @param data                                                             
 ///   @param ptr                                                              
 ///   @param end                                                              
-///   @param stream                                                           
-void Obj::parse_buffer(
-   Data* data, const char* ptr, const char* end, Ref<A::File::Reader>& stream
-) {
+void Obj::parse_buffer(Data* data, const char* ptr, const char* end) {
    const char* p;
    p = ptr;
 
@@ -320,13 +577,16 @@ void Obj::parse_buffer(
          p++;
 
          if (Token {p, p + 5} == "tllib" and is_whitespace(p[5])) {
-            ptr = skip_whitespace(ptr + 5);
-            auto e = (ptr = skip_name(ptr));
-            const Path lib = Token {ptr, e};
-            if (lib) {
-               auto file = stream->GetFile()->RelativeFile(lib);
-               if (file)
-                  read_mtllib(data, *file);
+            // When parsing in parallel, libraries are loaded in advance
+            if (data->file) {
+               auto s = skip_whitespace(p + 5);
+               auto e = skip_name(s);
+               const Path lib = Token {s, e};
+               if (lib) {
+                  auto mtl = data->file->RelativeFile(lib);
+                  if (mtl)
+                     read_mtllib(data->library, *mtl);
+               }
             }
          }
          break;
@@ -347,26 +607,19 @@ void Obj::parse_buffer(
 
       data->line++;
    }
-
-   if (data->mesh->colors) {
-      // Fill the remaining slots in the colors array                   
-      for (auto ii = data->mesh->colors.GetCount();
-                ii < data->mesh->positions.GetCount(); ++ii)
-         data->mesh->colors << 1;
-   }
 }
 
-/// @brief 
-/// @param data 
-/// @param file 
-/// @param stream 
-/// @return 
-int Obj::read_mtllib(Data* data, const A::File& file) {
+/// Load all materials from a material library                                
+///   @param library - [out] where materials are pushed                       
+///   @param file - the material library file                                 
+///   @return 1                                                               
+int Obj::read_mtllib(TMany<Material>* library, const A::File& file) {
    const char* s;
 
    // Read entire file                                                  
    auto contents = file.ReadAs<Text>();
    contents << '\n';
+   pad(contents);
 
    Material mtl;
    int found_d = 0;
@@ -383,7 +636,7 @@ int Obj::read_mtllib(Data* data, const A::File& file) {
          if (Token {p, p + 5} == "ewmtl" and is_whitespace(p[5])) {
             // Push previous material (if there is one)                 
             if (mtl.name) {
-               data->mesh->materials << mtl;
+               *library << mtl;
                mtl = {};
             }
 
@@ -457,15 +710,15 @@ int Obj::read_mtllib(Data* data, const A::File& file) {
 
                if (is_whitespace(p[1])) {
                   if (*p == 'a')
-                     p = read_map(data, p + 1, &mtl.map_Ka);
+                     p = read_map(nullptr, p + 1, &mtl.map_Ka);
                   else if (*p == 'd')
-                     p = read_map(data, p + 1, &mtl.map_Kd);
+                     p = read_map(nullptr, p + 1, &mtl.map_Kd);
                   else if (*p == 's')
-                     p = read_map(data, p + 1, &mtl.map_Ks);
+                     p = read_map(nullptr, p + 1, &mtl.map_Ks);
                   else if (*p == 'e')
-                     p = read_map(data, p + 1, &mtl.map_Ke);
+                     p = read_map(nullptr, p + 1, &mtl.map_Ke);
                   else if (*p == 't')
-                     p = read_map(data, p + 1, &mtl.map_Kt);
+                     p = read_map(nullptr, p + 1, &mtl.map_Kt);
                }
             }
             else if (*p == 'N') {
@@ -473,20 +726,20 @@ int Obj::read_mtllib(Data* data, const A::File& file) {
 
                if (is_whitespace(p[1])) {
                   if (*p == 's')
-                     p = read_map(data, p + 1, &mtl.map_Ns);
+                     p = read_map(nullptr, p + 1, &mtl.map_Ns);
                   else if (*p == 'i')
-                     p = read_map(data, p + 1, &mtl.map_Ni);
+                     p = read_map(nullptr, p + 1, &mtl.map_Ni);
                }
             }
             else if (*p == 'd') {
                p++;
 
                if (is_whitespace(*p))
-                  p = read_map(data, p, &mtl.map_d);
+                  p = read_map(nullptr, p, &mtl.map_d);
             }
             else if ((Token {p, p + 4} == "bump" or Token {p, p + 4} == "Bump")
             and is_whitespace(p[4])) {
-               p = read_map(data, p + 4, &mtl.map_bump);
+               p = read_map(nullptr, p + 4, &mtl.map_bump);
             }
          }
          break;
@@ -500,7 +753,7 @@ int Obj::read_mtllib(Data* data, const A::File& file) {
 
    // Push final material                                               
    if (mtl.name)
-      data->mesh->materials << mtl;
+      *library << mtl;
    return 1;
 }
 
@@ -562,16 +815,24 @@ const char* Obj::parse_normal(Data* data, const char* ptr) {
 /// Parses a face ('f') line                                                  
 /// A face in obj files can have more than three vertices, and form a 'fan'   
 /// topology. We handle those by triangulating and inserting the required     
-/// triangles.                                                                
+/// triangles. Triangles are emitted while vertices are parsed, by keeping    
+/// only the first and the previous vertex, so no per-face storage is needed  
 ///   @param data - [in/out] data store                                       
 ///   @param ptr - text to parse                                              
 ///   @return the end of the parsed region                                    
 const char* Obj::parse_face(Data* data, const char* ptr) {
    ptr = skip_whitespace(ptr);
 
-   TMany<Idx> p_seq;
-   TMany<Idx> t_seq;
-   TMany<Idx> n_seq;
+   // Indices are resolved against the vertex attributes of the whole   
+   // file parsed so far, including the ones in preceding chunks        
+   const auto positions = data->position_base + data->mesh->positions.GetCount();
+   const auto texcoords = data->texcoord_base + data->mesh->texcoords.GetCount();
+   const auto normals   = data->normal_base   + data->mesh->normals.GetCount();
+
+   // Position/texture/normal indices of the first and previous vertex  
+   Idx first[3] {};
+   Idx previous[3] {};
+   Count vertices = 0;
 
    // For each vertex in the face definition...                         
    while (not is_newline(*ptr)) {
@@ -592,47 +853,59 @@ const char* Obj::parse_face(Data* data, const char* ptr) {
          }
       }
 
-      // Push position index                                            
+      Idx current[3];
+
+      // Position index                                                 
       if (v < 0)
-         p_seq << static_cast<Idx>(data->mesh->positions.GetCount() - static_cast<Count>(-v));
-      else if (v > 0 and v < static_cast<int>(data->mesh->positions.GetCount()))
-         p_seq << static_cast<Idx>(v);
+         current[0] = static_cast<Idx>(positions - static_cast<Count>(-v));
+      else if (v > 0 and v < static_cast<int>(positions))
+         current[0] = static_cast<Idx>(v);
       else {
          // Skip lines with no valid vertex index                       
          ptr = skip_whitespace(ptr);
          continue;
       }
 
-      // Push texture coordinate index                                  
+      // Texture coordinate index                                       
       if (t < 0)
-         t_seq << static_cast<Idx>(data->mesh->texcoords.GetCount() - static_cast<Count>(-t));
-      else if (t > 0 and t < static_cast<int>(data->mesh->texcoords.GetCount()))
-         t_seq << static_cast<Idx>(t);
+         current[1] = static_cast<Idx>(texcoords - static_cast<Count>(-t));
+      else if (t > 0 and t < static_cast<int>(texcoords))
+         current[1] = static_cast<Idx>(t);
       else
-         t_seq << 0;
+         current[1] = 0;
 
-      // Push normal index                                              
+      // Normal index                                                   
       if (n < 0)
-         n_seq << static_cast<Idx>(data->mesh->normals.GetCount() - static_cast<Count>(-n));
-      else if (n > 0 and n < static_cast<int>(data->mesh->normals.GetCount()))
-         n_seq << static_cast<Idx>(n);
+         current[2] = static_cast<Idx>(normals - static_cast<Count>(-n));
+      else if (n > 0 and n < static_cast<int>(normals))
+         current[2] = static_cast<Idx>(n);
       else
-         n_seq << 0;
+         current[2] = 0;
+
+      // Triangulate the face as a fan                                  
+      // https://stackoverflow.com/questions/23723993                   
+      if (vertices == 0) {
+         first[0] = current[0];
+         first[1] = current[1];
+         first[2] = current[2];
+      }
+      else if (vertices >= 2) {
+         data->mesh->mPositionIndices << first[0] << previous[0] << current[0];
+         data->mesh->mTextureIndices  << first[1] << previous[1] << current[1];
+         data->mesh->mNormalIndices   << first[2] << previous[2] << current[2];
+
+         data->mesh->face_vertices    << 3;
+         data->mesh->face_materials   << data->material;
+         data->group.face_count++;
+         data->object.face_count++;
+      }
 
-      ptr = skip_whitespace(ptr);
-   }
+      previous[0] = current[0];
+      previous[1] = current[1];
+      previous[2] = current[2];
+      ++vertices;
 
-   // Triangulate the face                                              
-   // https://stackoverflow.com/questions/23723993                      
-   for (Count i = 2; i < p_seq.GetCount(); ++i) {
-      data->mesh->mPositionIndices << p_seq[0] << p_seq[i - 1] << p_seq[i];
-      data->mesh->mTextureIndices  << t_seq[0] << t_seq[i - 1] << t_seq[i];
-      data->mesh->mNormalIndices   << n_seq[0] << n_seq[i - 1] << n_seq[i];
-
-      data->mesh->face_vertices    << 3;
-      data->mesh->face_materials   << data->material;
-      data->group.face_count++;
-      data->object.face_count++;
+      ptr = skip_whitespace(ptr);
    }
 
    return ptr;
@@ -671,11 +944,20 @@ const char* Obj::parse_usemtl(Data* data, const char* ptr) {
    auto e = (ptr = skip_name(ptr));
 
    // Find an existing material with the same name                      
-   Material* mtl;
-   unsigned idx = 0;
+   Offset idx = 0;
+   while (idx < data->library->GetCount()) {
+      if ((*data->library)[idx].name == Token(s, e)) {
+         data->material = idx;
+         return ptr;
+      }
+
+      idx++;
+   }
+
+   // Otherwise look through the chunk's own fallback materials         
+   idx = 0;
    while (idx < data->mesh->materials.GetCount()) {
-      mtl = &data->mesh->materials[idx];
-      if (mtl->name == Token(s, e))
+      if (data->mesh->materials[idx].name == Token(s, e))
          break;
 
       idx++;
@@ -690,7 +972,7 @@ const char* Obj::parse_usemtl(Data* data, const char* ptr) {
       data->mesh->materials << new_mtl;
    }
 
-   data->material = idx;
+   data->material = FallbackMaterial | idx;
    return ptr;
 }
 
@@ -739,133 +1021,48 @@ const char* Obj::read_map(Data*, const char* ptr, Texture* map) {
    return ptr;
 }
 
-/// @brief 
-/// @param ptr 
-/// @param val 
-/// @return 
+/// Parse a signed integer                                                    
+///   @param ptr - text to parse                                              
+///   @param val - [out] the parsed number                                    
+///   @return a pointer to the first symbol after the number                  
 const char* Obj::parse_int(const char* ptr, int* val) {
-   int sign;
-   int num;
-
-   if (*ptr == '-') {
-      sign = -1;
-      ptr++;
-   }
-   else sign = +1;
-
-   num = 0;
-   while (is_digit(*ptr))
-      num = 10 * num + (*ptr++ - '0');
-
-   *val = sign * num;
-   return ptr;
+   return Scanner::ParseInt(ptr, val);
 }
 
-/// @brief 
-/// @param ptr 
-/// @param val 
-/// @return 
+/// Parse a floating point number                                             
+///   @param ptr - text to parse                                              
+///   @param val - [out] the parsed number                                    
+///   @return a pointer to the first symbol after the number                  
 const char* Obj::parse_float(const char* ptr, float* val) {
-   double        sign;
-   double        num;
-   double        fra;
-   double        div;
-   unsigned int  eval;
-   const double* powers;
-
-
-   ptr = skip_whitespace(ptr);
-
-   switch (*ptr) {
-   case '+':
-      sign = 1.0;
-      ptr++;
-      break;
-
-   case '-':
-      sign = -1.0;
-      ptr++;
-      break;
-
-   default:
-      sign = 1.0;
-      break;
-   }
-
-
-   num = 0.0;
-   while (is_digit(*ptr))
-      num = 10.0 * num + (double)(*ptr++ - '0');
-
-   if (*ptr == '.')
-      ptr++;
-
-   fra = 0.0;
-   div = 1.0;
-
-   while (is_digit(*ptr)) {
-      fra = 10.0 * fra + (double)(*ptr++ - '0');
-      div *= 10.0;
-   }
-
-   num += fra / div;
-
-   if (is_exponent(*ptr)) {
-      ptr++;
-
-      switch (*ptr) {
-      case '+':
-         powers = POWER_10_POS;
-         ptr++;
-         break;
-
-      case '-':
-         powers = POWER_10_NEG;
-         ptr++;
-         break;
-
-      default:
-         powers = POWER_10_POS;
-         break;
-      }
-
-      eval = 0;
-      while (is_digit(*ptr))
-         eval = 10 * eval + (*ptr++ - '0');
-
-      num *= (eval >= MAX_POWER) ? 0.0 : powers[eval];
-   }
-
-   *val = (float)(sign * num);
-   return ptr;
+   return Scanner::ParseFloat(ptr, val);
 }
 
 /// @brief 
 /// @param c 
 /// @return 
 int Obj::is_whitespace(char c) {
-   return c == ' ' or c == '\t' or c == '\r';
+   return Scanner::IsWhitespace(c);
 }
 
 /// @brief 
 /// @param c 
 /// @return 
 int Obj::is_newline(char c) {
-   return c == '\n';
+   return Scanner::IsNewline(c);
 }
 
 /// @brief 
 /// @param c 
 /// @return 
 int Obj::is_digit(char c) {
-   return c >= '0' and c <= '9';
+   return Scanner::IsDigit(c);
 }
 
 /// @brief 
 /// @param c 
 /// @return 
 int Obj::is_exponent(char c) {
-   return c == 'e' or c == 'E';
+   return Scanner::IsExponent(c);
 }
 
 /// Skip a name by going to the end of the line, and reverting back to first  
@@ -885,28 +1082,42 @@ const char* Obj::skip_name(const char* ptr) {
 ///   @param ptr - data to scan                                               
 ///   @return a pointer to beginning of next non-whitespace symbol            
 const char* Obj::skip_whitespace(const char* ptr) {
-   while (is_whitespace(*ptr))
-      ++ptr;
-   return ptr;
+   return Scanner::SkipWhitespace(ptr);
 }
 
 /// Skip forward until a new line begins                                      
 ///   @param ptr - data to scan                                               
 ///   @return a pointer to beginning of next line                             
 const char* Obj::skip_line(const char* ptr) {
-   while (not is_newline(*ptr++))
-      ;
-   return ptr;
+   return Scanner::SkipLine(ptr);
+}
+
+/// Allocate and clear the bytes past the end of a buffer, that vectorized    
+/// scanning might read - see Scanner::Padding                                
+///   @param buffer - [in/out] the buffer to pad, its count doesn't change    
+void Obj::pad(Text& buffer) {
+   buffer.Reserve(buffer.GetCount() + Scanner::Padding);
+   LANGULUS_ASSUME(DevAssumes,
+      buffer.GetReserved() >= buffer.GetCount() + Scanner::Padding,
+      "Buffer isn't padded");
+   ::std::memset(buffer.GetRawEnd(), 0, Scanner::Padding);
 }
 
 /// Add the currently staged object to content                                
 ///   @param data - mesh data                                                 
 void Obj::flush_object(Data* data) {
-   // Add object if not empty                                           
-   if (data->object.face_count > 0)
+   if (data->leading_object) {
+      // The first object in a chunk is merged with the previous chunk  
+      data->lead_object = Move(data->object);
+      data->leading_object = false;
+   }
+   else if (data->object.face_count > 0) {
+      // Add object if not empty                                        
       data->mesh->objects << Move(data->object);
+   }
 
    // Reset for more data                                               
+   data->object = {};
    data->object.face_offset = data->mesh->face_vertices.GetCount();
    data->object.index_offset = data->mesh->mPositionIndices.GetCount();
 }
@@ -914,11 +1125,18 @@ void Obj::flush_object(Data* data) {
 /// Add the currently staged group to content                                 
 ///   @param data - mesh data                                                 
 void Obj::flush_group(Data* data) {
-   // Add group if not empty                                            
-   if (data->group.face_count > 0)
+   if (data->leading_group) {
+      // The first group in a chunk is merged with the previous chunk   
+      data->lead_group = Move(data->group);
+      data->leading_group = false;
+   }
+   else if (data->group.face_count > 0) {
+      // Add group if not empty                                         
       data->mesh->groups << Move(data->group);
+   }
 
    // Reset for more data                                               
+   data->group = {};
    data->group.face_offset = data->mesh->face_vertices.GetCount();
    data->group.index_offset = data->mesh->mPositionIndices.GetCount();
 }
\ No newline at end of file
@@ -0,0 +1,223 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include "Workers.hpp"
+#include <Langulus/IO.hpp>
+#include <functional>
+#include <vector>
+
+
+///                                                                           
+///   An *.OBJ file representation and interface                              
+///                                                                           
+/// Based on fast_obj v1.2 https://github.com/thisistherk/fast_obj            
+/// Completely rewritten to use Langulus containers and C++20                 
+/// TODO test if actually faster and contribute back if so                    
+///                                                                           
+struct Obj {
+
+   using Idx = unsigned;
+
+   /// Parsed texture descriptor                                              
+   struct Texture {
+      Text name;                 // Texture name from .mtl file         
+   };
+
+   /// Parsed material descriptor                                             
+   struct Material {
+      Text name;                 // Material name                       
+
+      float Ka[3] = {0, 0, 0};   // Ambient                             
+      float Kd[3] = {1, 1, 1};   // Diffuse                             
+      float Ks[3] = {0, 0, 0};   // Specular                            
+      float Ke[3] = {0, 0, 0};   // Emission                            
+      float Kt[3] = {0, 0, 0};   // Transmittance                       
+      float Ns = 1;              // Shininess                           
+      float Ni = 1;              // Index of refraction                 
+      float Tf[3] = {1, 1, 1};   // Transmission filter                 
+      float d = 1;               // Disolve (alpha)                     
+      int   illum = 1;           // Illumination model                  
+
+      // Set for materials that don't come from the associated mtllib   
+      int   fallback = 0;
+
+      // Texture maps                                                   
+      Texture map_Ka;
+      Texture map_Kd;
+      Texture map_Ks;
+      Texture map_Ke;
+      Texture map_Kt;
+      Texture map_Ns;
+      Texture map_Ni;
+      Texture map_d;
+      Texture map_bump;
+   };
+
+   /// Parsed object group                                                    
+   struct Group {
+      Text name;                 // Group name                          
+      Offset face_count = 0;     // Number of faces                     
+      Offset face_offset = 0;    // First face in fastObjMesh face_* arrays
+      Offset index_offset = 0;   // First index in fastObjMesh indices array
+   };
+
+   /// Parsed object mesh                                                     
+   struct Mesh {
+      // Vertex data                                                    
+      TMany<Vec3f> positions;
+      TMany<Vec2f> texcoords;
+      TMany<Vec3f> normals;
+      TMany<Vec3f> colors;
+
+      // Face data: one element for each face                           
+      Count          face_count;
+      TMany<Offset>  face_vertices;
+      TMany<Offset>  face_materials;
+
+      // Indices for each vertex attribute                              
+      TMany<Idx>   mPositionIndices;
+      TMany<Idx>   mTextureIndices;
+      TMany<Idx>   mNormalIndices;
+
+      // Materials                                                      
+      TMany<Material> materials;
+
+      // Mesh objects ('o' tag in .obj file)                            
+      TMany<Group>    objects;
+
+      // Mesh groups ('g' tag in .obj file)                             
+      TMany<Group>    groups;
+   };
+
+
+   struct Data {
+      // Mesh that receives the parsed chunk                            
+      Mesh* mesh;
+
+      // Materials loaded from material libraries. Material indices     
+      // below FallbackMaterial refer to this list                      
+      TMany<Material>* library;
+
+      // The file being parsed, if material libraries should be loaded  
+      // as they are encountered. Null when parsing in parallel, in     
+      // which case libraries are loaded before any chunk is parsed     
+      const A::File* file;
+
+      // Current object/group                                           
+      Group object;
+      Group group;
+
+      // The object/group that was open when the chunk started. It is   
+      // a continuation of the one left open by the previous chunk      
+      Group lead_object;
+      Group lead_group;
+      bool leading_object = true;
+      bool leading_group = true;
+
+      // Current material index                                         
+      Offset material;
+
+      // Number of vertex attributes in all preceding chunks, so that   
+      // relative face indices can be resolved while parsing            
+      Count position_base = 0;
+      Count texcoord_base = 0;
+      Count normal_base = 0;
+
+      // Current line in file                                           
+      Offset line;
+   };
+
+   /// A newline-aligned part of the file, parsed on its own by a worker      
+   struct Chunk {
+      const char* begin;
+      const char* end;
+
+      // Vertex attributes, faces and material libraries in the chunk,  
+      // counted in advance to resolve relative face indices, and to    
+      // reserve memory                                                 
+      Count positions = 0;
+      Count texcoords = 0;
+      Count normals = 0;
+      Count faces = 0;
+      TMany<Path> libraries;
+
+      // Lines in the chunk, so that the following chunks know their    
+      // line numbers                                                   
+      Count lines = 0;
+
+      Mesh mesh;
+      Data data;
+   };
+
+   /// State carried between chunks, while merging them in order              
+   struct Merge {
+      Group object;
+      Group group;
+      Offset material = 0;
+   };
+
+   // Material index of a face, that uses the material set by the       
+   // usemtl statement of some previous chunk                           
+   static constexpr Offset NoMaterial = ~Offset {0};
+
+   // Set on material indices that refer to a chunk's own fallback      
+   // materials, instead of the shared library                          
+   static constexpr Offset FallbackMaterial = Offset {1} << (sizeof(Offset) * 8 - 1);
+
+   // Size of buffer to read into                                       
+   static constexpr size_t BufferSize = 65536;
+
+   // Files are split into chunks of at least this size, when parsed    
+   // in parallel                                                       
+   static constexpr size_t MinChunkSize = 1024 * 1024;
+
+   /// Receives the data parsed so far, when parsing progressively            
+   using Publish = ::std::function<void(const Mesh&)>;
+
+   static int is_whitespace(char c);
+   static int is_newline(char c);
+   static int is_digit(char c);
+   static int is_exponent(char c);
+   static const char* skip_name(const char* ptr);
+   static const char* skip_whitespace(const char* ptr);
+   static const char* skip_line(const char* ptr);
+   static void pad(Text& buffer);
+   static void flush_object(Data* data);
+   static void flush_group(Data* data);
+   static const char* parse_int(const char* ptr, int* val);
+   static const char* parse_float(const char* ptr, float* val);
+   static const char* parse_vertex(Data* data, const char* ptr);
+   static const char* parse_texcoord(Data* data, const char* ptr);
+   static const char* parse_normal(Data* data, const char* ptr);
+   static const char* parse_face(Data* data, const char* ptr);
+   static const char* parse_object(Data* data, const char* ptr);
+   static const char* parse_group(Data* data, const char* ptr);
+   static const char* parse_usemtl(Data* data, const char* ptr);
+   static const char* read_mtl_int(const char* p, int* v);
+   static const char* read_mtl_single(const char* p, float* v);
+   static const char* read_mtl_triple(const char* p, float v[3]);
+   static const char* read_map(Data* data, const char* ptr, Texture* map);
+   static int read_mtllib(TMany<Material>* library, const A::File& file);
+   static void parse_buffer(Data* data, const char* ptr, const char* end);
+   static void parse_parallel(Mesh& out, const char* ptr, const char* end, const A::File* file, Workers& workers, size_t count);
+   static void parse_progressive(Mesh& out, const char* ptr, const char* end, const A::File& file, Workers& workers, size_t step, const Publish& publish);
+   static auto split(const char* ptr, const char* end, size_t count) -> ::std::vector<Chunk>;
+   static void count_buffer(Chunk* chunk);
+   static void begin_chunk(Data* data, Mesh* mesh, TMany<Material>* library, bool first);
+   static void reserve(Mesh& mesh, Count positions, Count texcoords, Count normals, Count faces);
+   static void merge_chunk(Mesh& out, Merge& state, Data& chunk);
+   static void merge_groups(TMany<Group>& out, Group& open, TMany<Group>& in, Group& lead, bool leading, Group& current, Count faceBase, Count indexBase);
+   static void finish_merge(Mesh& out, Merge& state);
+   static bool read_view(Mesh& out, const A::File& file, Workers& workers, size_t step, const Publish& publish);
+   static void read_chunked(Mesh& out, const A::File& file);
+
+   template<class T>
+   static void append(TMany<T>& to, TMany<T>& from);
+};
+
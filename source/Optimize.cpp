@@ -0,0 +1,331 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Optimize.hpp"
+#include "Mesh.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+/// Simulate a FIFO post-transform vertex cache over an index buffer          
+///   @param indices - the triangle list indices                              
+///   @param count - number of indices                                        
+///   @param vertices - number of vertices                                    
+///   @param cache - size of the simulated cache                              
+///   @return the cache statistics                                            
+VertexCache::Stats VertexCache::Analyze(
+   const uint32_t* indices, Count count, Count vertices, Count cache
+) {
+   Stats stats;
+   if (count < 3 or not vertices)
+      return stats;
+
+   // Each vertex remembers when it entered the cache, so that a lookup 
+   // is just a comparison against the number of misses so far          
+   TMany<Count> entered;
+   entered.Reserve<true>(vertices);
+   for (auto& e : entered)
+      e = 0;
+
+   Count misses = 0;
+   Count referenced = 0;
+   for (Offset i = 0; i < count; ++i) {
+      auto& e = entered[indices[i]];
+      if (e and misses - e < cache)
+         continue;
+
+      referenced += e == 0;
+      e = ++misses;
+   }
+
+   stats.acmr = static_cast<float>(misses) / static_cast<float>(count / 3);
+   stats.atvr = static_cast<float>(misses) / static_cast<float>(referenced);
+   return stats;
+}
+
+/// Find a triangle order with good post-transform vertex cache locality,     
+/// using Tipsify. It fans around a vertex, emitting all of its triangles,    
+/// then picks the next fanning vertex among the ones just emitted, that      
+/// are most likely to still be in the cache. Runs in linear time             
+///   @param indices - the triangle list indices                              
+///   @param count - number of indices                                        
+///   @param vertices - number of vertices                                    
+///   @param cache - size of the targeted cache                               
+///   @return the new order of the triangles, as triangle indices             
+TMany<uint32_t> VertexCache::ReorderTriangles(
+   const uint32_t* indices, Count count, Count vertices, Count cache
+) {
+   const auto triangles = count / 3;
+   TMany<uint32_t> order;
+   order.Reserve(triangles);
+   if (not triangles)
+      return order;
+
+   // Triangle adjacency for each vertex, in compressed row form        
+   TMany<uint32_t> live;
+   live.Reserve<true>(vertices);
+   for (auto& l : live)
+      l = 0;
+   for (Offset i = 0; i < triangles * 3; ++i)
+      ++live[indices[i]];
+
+   TMany<uint32_t> offsets;
+   offsets.Reserve<true>(vertices + 1);
+   offsets[0] = 0;
+   for (Offset v = 0; v < vertices; ++v)
+      offsets[v + 1] = offsets[v] + live[v];
+
+   TMany<uint32_t> adjacency;
+   adjacency.Reserve<true>(triangles * 3);
+   {
+      TMany<uint32_t> fill;
+      fill.Reserve<true>(vertices);
+      ::std::memcpy(fill.GetRaw(), offsets.GetRaw(), vertices * sizeof(uint32_t));
+      for (Offset i = 0; i < triangles * 3; ++i)
+         adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+   }
+
+   // Time each vertex entered the cache, and whether a triangle is out 
+   TMany<Count> stamps;
+   stamps.Reserve<true>(vertices);
+   for (auto& s : stamps)
+      s = 0;
+
+   TMany<uint8_t> emitted;
+   emitted.Reserve<true>(triangles);
+   for (auto& e : emitted)
+      e = 0;
+
+   // Vertices of emitted triangles, to recover from dead ends. Every   
+   // vertex of every triangle is pushed at most once                   
+   TMany<uint32_t> deadEnds;
+   deadEnds.Reserve<true>(triangles * 3);
+   Count deadEndCount = 0;
+   TMany<uint32_t> candidates;
+
+   Count time = cache + 1;
+   Offset cursor = 0;
+   int64_t fanning = 0;
+
+   while (fanning >= 0) {
+      candidates.Clear();
+
+      // Emit all triangles around the fanning vertex                   
+      const auto f = static_cast<uint32_t>(fanning);
+      for (auto a = offsets[f]; a < offsets[f + 1]; ++a) {
+         const auto t = adjacency[a];
+         if (emitted[t])
+            continue;
+
+         for (Offset k = 0; k < 3; ++k) {
+            const auto v = indices[t * 3 + k];
+            deadEnds[deadEndCount++] = v;
+            candidates << v;
+            --live[v];
+
+            if (time - stamps[v] > cache)
+               stamps[v] = time++;
+         }
+
+         emitted[t] = 1;
+         order << t;
+      }
+
+      // Pick the candidate that will still be in the cache after its   
+      // remaining triangles are emitted, and that entered it earliest  
+      fanning = -1;
+      int64_t best = -1;
+      for (auto v : candidates) {
+         if (not live[v])
+            continue;
+
+         int64_t priority = 0;
+         if (time - stamps[v] + 2 * live[v] <= cache)
+            priority = static_cast<int64_t>(time - stamps[v]);
+
+         if (priority > best) {
+            best = priority;
+            fanning = v;
+         }
+      }
+
+      if (fanning >= 0)
+         continue;
+
+      // Dead end - resume from a recently used vertex, or from the     
+      // next vertex in input order that still has triangles            
+      while (deadEndCount) {
+         const auto v = deadEnds[--deadEndCount];
+         if (live[v]) {
+            fanning = v;
+            break;
+         }
+      }
+
+      while (fanning < 0 and cursor < vertices) {
+         if (live[cursor])
+            fanning = static_cast<int64_t>(cursor);
+         ++cursor;
+      }
+   }
+
+   return order;
+}
+
+/// Renumber vertices in the order they're first referenced, so that the      
+/// vertex fetch reads memory mostly sequentially. Unreferenced vertices      
+/// are moved to the end                                                      
+///   @param indices - [in/out] the indices to renumber                       
+///   @param count - number of indices                                        
+///   @param vertices - number of vertices                                    
+///   @return the new index of each old vertex                                
+TMany<uint32_t> VertexCache::ReorderVertices(
+   uint32_t* indices, Count count, Count vertices
+) {
+   constexpr uint32_t Unused = ~uint32_t {0};
+   TMany<uint32_t> remap;
+   remap.Reserve<true>(vertices);
+   for (auto& r : remap)
+      r = Unused;
+
+   uint32_t next = 0;
+   for (Offset i = 0; i < count; ++i) {
+      auto& r = remap[indices[i]];
+      if (r == Unused)
+         r = next++;
+      indices[i] = r;
+   }
+
+   for (auto& r : remap) {
+      if (r == Unused)
+         r = next++;
+   }
+
+   return remap;
+}
+
+namespace VertexCache {
+
+   /// Overwrite an index stream with 32-bit indices, keeping its width       
+   ///   @param stream - [out] the 16 or 32-bit index stream                  
+   ///   @param indices - the indices to write                                
+   inline void Narrow(Many& stream, const TMany<uint32_t>& indices) {
+      if (stream.GetStride() == sizeof(uint16_t)) {
+         auto to = reinterpret_cast<uint16_t*>(stream.GetRaw());
+         for (auto i : indices)
+            *to++ = static_cast<uint16_t>(i);
+      }
+      else ::std::memcpy(stream.GetRaw(), indices.GetRaw(), stream.GetBytesize());
+   }
+
+   /// Move each element of a vertex stream to its new place                  
+   ///   @param stream - [in/out] the vertex stream                           
+   ///   @param remap - the new index of each element                         
+   inline void Permute(Many& stream, const TMany<uint32_t>& remap) {
+      const auto stride = stream.GetStride();
+      TMany<Byte> copy;
+      copy.Reserve<true>(stream.GetBytesize());
+      ::std::memcpy(copy.GetRaw(), stream.GetRaw(), stream.GetBytesize());
+
+      auto to = stream.GetRaw();
+      auto from = copy.GetRaw();
+      for (auto r : remap) {
+         ::std::memcpy(to + r * stride, from, stride);
+         from += stride;
+      }
+   }
+
+} // namespace VertexCache
+
+/// Reorder the committed triangle list for post-transform vertex cache       
+/// efficiency, and then the vertices for fetch locality. Meshes that are     
+/// indexed per attribute get their triangles reordered in all index          
+/// streams, but their vertices are left as they are                          
+///   @param vertices - whether vertex streams can be reordered, which is     
+///      possible only if all of them were already committed                  
+void Mesh::Optimize(bool vertices) {
+   if (not mView.mTopology
+   or mView.mTopology->CastsTo<A::TriangleStrip>()
+   or not mView.mTopology->CastsTo<A::Triangle>())
+      return;
+
+   // Gather the index streams                                          
+   Many* streams[3] {};
+   Count streamCount = 0;
+   while (streamCount < 3) {
+      auto stream = GetData<Traits::Index>(streamCount);
+      if (not stream or stream->IsEmpty())
+         break;
+
+      const auto stride = stream->GetStride();
+      if (stride != sizeof(uint16_t) and stride != sizeof(uint32_t))
+         return;
+      streams[streamCount++] = stream;
+   }
+
+   if (not streamCount)
+      return;
+
+   auto indices = GatherIndices();
+   const auto count = indices.GetCount() - indices.GetCount() % 3;
+   Count vertexCount = 0;
+   for (auto i : indices)
+      vertexCount = ::std::max(vertexCount, static_cast<Count>(i) + 1);
+
+   const auto positions = GetData<Traits::Place>();
+   if (positions)
+      vertexCount = ::std::max(vertexCount, positions->GetCount());
+
+   const auto before = VertexCache::Analyze(indices.GetRaw(), count, vertexCount);
+
+   // Reorder the triangles in all index streams                        
+   const auto order = VertexCache::ReorderTriangles(indices.GetRaw(), count, vertexCount);
+   for (Count s = 0; s < streamCount; ++s) {
+      const auto original = GatherIndices(s);
+      auto reordered = GatherIndices(s);
+      for (Offset t = 0; t < order.GetCount(); ++t) {
+         reordered[t * 3 + 0] = original[order[t] * 3 + 0];
+         reordered[t * 3 + 1] = original[order[t] * 3 + 1];
+         reordered[t * 3 + 2] = original[order[t] * 3 + 2];
+      }
+
+      VertexCache::Narrow(*streams[s], reordered);
+   }
+
+   indices = GatherIndices();
+
+   // Reorder the vertices, if there's a single index buffer, and all   
+   // vertex streams are per vertex                                     
+   Many* attributes[] {
+      GetData<Traits::Place>(),
+      GetData<Traits::Aim>(),
+      GetData<Traits::Sampler>(),
+      GetData<Traits::Color>()
+   };
+
+   bool perVertex = vertices and streamCount == 1;
+   for (auto attribute : attributes) {
+      if (attribute and not attribute->IsEmpty()
+      and attribute->GetCount() != vertexCount)
+         perVertex = false;
+   }
+
+   if (perVertex) {
+      const auto remap = VertexCache::ReorderVertices(indices.GetRaw(), count, vertexCount);
+      VertexCache::Narrow(*streams[0], indices);
+
+      for (auto attribute : attributes) {
+         if (attribute and not attribute->IsEmpty())
+            VertexCache::Permute(*attribute, remap);
+      }
+   }
+
+   const auto after = VertexCache::Analyze(indices.GetRaw(), count, vertexCount);
+   Logger::Verbose(Self(), "Optimized for a vertex cache of ", VertexCache::CacheSize,
+      ": ACMR ", before.acmr, " -> ", after.acmr,
+      ", ATVR ", before.atvr, " -> ", after.atvr);
+}
@@ -0,0 +1,37 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+
+
+///                                                                           
+///   Index buffer optimization                                               
+///                                                                           
+/// Reorders triangles for post-transform vertex cache locality, using the    
+/// Tipsify algorithm by Sander, Nehab and Barczak, and then reorders the     
+/// vertices in the order they are first used, for vertex fetch locality      
+///                                                                           
+namespace VertexCache {
+
+   /// Size of the simulated post-transform vertex cache                      
+   constexpr Count CacheSize = 16;
+
+   /// Vertex cache efficiency of an index buffer                             
+   struct Stats {
+      // Average cache miss ratio - transformed vertices per triangle   
+      float acmr = 0;
+      // Average transform to vertex ratio - transformed vertices per   
+      // referenced vertex, where 1 is the optimum                      
+      float atvr = 0;
+   };
+
+   Stats Analyze(const uint32_t*, Count indices, Count vertices, Count cache = CacheSize);
+   TMany<uint32_t> ReorderTriangles(const uint32_t*, Count indices, Count vertices, Count cache = CacheSize);
+   TMany<uint32_t> ReorderVertices(uint32_t*, Count indices, Count vertices);
+
+} // namespace VertexCache
@@ -0,0 +1,543 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+   #define LANGULUS_SCANNER_X86 1
+   #include <immintrin.h>
+   #if defined(_MSC_VER)
+      #include <intrin.h>
+   #endif
+   #if defined(_MSC_VER) && !defined(__clang__)
+      #define LANGULUS_SCANNER_AVX2
+   #else
+      #define LANGULUS_SCANNER_AVX2 __attribute__((target("avx2")))
+   #endif
+#else
+   #define LANGULUS_SCANNER_X86 0
+#endif
+
+
+///                                                                           
+///   Text scanning and number parsing for the OBJ/MTL readers                
+///                                                                           
+/// Every routine has a scalar reference implementation, and a vectorized     
+/// one that classifies 16 (SSE2) or 32 (AVX2) bytes at a time and converts   
+/// up to eight digits at once. The instruction set is picked at runtime.     
+/// Vectorized results are bit-identical to the scalar ones.                  
+///                                                                           
+/// All scanning stops at a newline, and buffers must always end with one.    
+/// Vector loads start at the scanned symbol, so they never read before it,   
+/// but they might read up to Padding bytes past the final newline, so        
+/// buffers must have that many more bytes allocated after their end.         
+///                                                                           
+namespace Scanner
+{
+
+   // Bytes past the final newline of a buffer, that vectorized kernels 
+   // might read, but never use                                         
+   constexpr size_t Padding = 32;
+
+   // Max supported power when parsing float                            
+   constexpr unsigned MAX_POWER = 20;
+
+   constexpr double POWER_10_POS[MAX_POWER] = {
+       1.0e0,  1.0e1,  1.0e2,  1.0e3,  1.0e4,  1.0e5,  1.0e6,  1.0e7,  1.0e8,  1.0e9,
+       1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16, 1.0e17, 1.0e18, 1.0e19,
+   };
+
+   constexpr double POWER_10_NEG[MAX_POWER] = {
+       1.0e0,   1.0e-1,  1.0e-2,  1.0e-3,  1.0e-4,  1.0e-5,  1.0e-6,  1.0e-7,  1.0e-8,  1.0e-9,
+       1.0e-10, 1.0e-11, 1.0e-12, 1.0e-13, 1.0e-14, 1.0e-15, 1.0e-16, 1.0e-17, 1.0e-18, 1.0e-19,
+   };
+
+   constexpr bool IsWhitespace(char c) noexcept {
+      return c == ' ' or c == '\t' or c == '\r';
+   }
+
+   constexpr bool IsNewline(char c) noexcept {
+      return c == '\n';
+   }
+
+   constexpr bool IsDigit(char c) noexcept {
+      return c >= '0' and c <= '9';
+   }
+
+   constexpr bool IsExponent(char c) noexcept {
+      return c == 'e' or c == 'E';
+   }
+
+   /// Set of scanning kernels for a specific instruction set                 
+   struct Kernels {
+      const char* (*SkipWhitespace)(const char*);
+      const char* (*SkipLine)(const char*);
+      const char* (*SkipDigits)(const char*);
+      const char* mName;
+   };
+
+
+   ///                                                                        
+   ///   Scalar reference implementation                                      
+   ///                                                                        
+   namespace Scalar
+   {
+
+      /// Skip all whitespace forward                                         
+      ///   @param ptr - data to scan                                         
+      ///   @return a pointer to beginning of next non-whitespace symbol      
+      inline const char* SkipWhitespace(const char* ptr) {
+         while (IsWhitespace(*ptr))
+            ++ptr;
+         return ptr;
+      }
+
+      /// Skip forward until a new line begins                                
+      ///   @param ptr - data to scan                                         
+      ///   @return a pointer to beginning of next line                       
+      inline const char* SkipLine(const char* ptr) {
+         while (not IsNewline(*ptr++))
+            ;
+         return ptr;
+      }
+
+      /// Skip a run of decimal digits                                        
+      ///   @param ptr - data to scan                                         
+      ///   @return a pointer to the first symbol that isn't a digit          
+      inline const char* SkipDigits(const char* ptr) {
+         while (IsDigit(*ptr))
+            ++ptr;
+         return ptr;
+      }
+
+      /// Parse a signed integer. Integers that don't fit wrap around modulo  
+      /// 2^32, so -2147483648 is parsed exactly                              
+      ///   @param ptr - data to scan                                         
+      ///   @param val - [out] the parsed number                              
+      ///   @return a pointer to the first symbol after the number            
+      inline const char* ParseInt(const char* ptr, int* val) {
+         bool     negative;
+         unsigned num;
+
+         if (*ptr == '-') {
+            negative = true;
+            ptr++;
+         }
+         else negative = false;
+
+         // Accumulated unsigned, so that overflow is well defined      
+         num = 0;
+         while (IsDigit(*ptr))
+            num = 10 * num + static_cast<unsigned>(*ptr++ - '0');
+
+         *val = static_cast<int>(negative ? 0u - num : num);
+         return ptr;
+      }
+
+      /// Parse a floating point number, with optional fraction and exponent  
+      ///   @param ptr - data to scan, leading whitespace is skipped          
+      ///   @param val - [out] the parsed number                              
+      ///   @return a pointer to the first symbol after the number            
+      inline const char* ParseFloat(const char* ptr, float* val) {
+         double        sign;
+         double        num;
+         double        fra;
+         double        div;
+         unsigned int  eval;
+         const double* powers;
+
+         ptr = SkipWhitespace(ptr);
+
+         switch (*ptr) {
+         case '+':
+            sign = 1.0;
+            ptr++;
+            break;
+
+         case '-':
+            sign = -1.0;
+            ptr++;
+            break;
+
+         default:
+            sign = 1.0;
+            break;
+         }
+
+         num = 0.0;
+         while (IsDigit(*ptr))
+            num = 10.0 * num + (double)(*ptr++ - '0');
+
+         if (*ptr == '.')
+            ptr++;
+
+         fra = 0.0;
+         div = 1.0;
+
+         while (IsDigit(*ptr)) {
+            fra = 10.0 * fra + (double)(*ptr++ - '0');
+            div *= 10.0;
+         }
+
+         num += fra / div;
+
+         if (IsExponent(*ptr)) {
+            ptr++;
+
+            switch (*ptr) {
+            case '+':
+               powers = POWER_10_POS;
+               ptr++;
+               break;
+
+            case '-':
+               powers = POWER_10_NEG;
+               ptr++;
+               break;
+
+            default:
+               powers = POWER_10_POS;
+               break;
+            }
+
+            eval = 0;
+            while (IsDigit(*ptr))
+               eval = 10 * eval + (*ptr++ - '0');
+
+            num *= (eval >= MAX_POWER) ? 0.0 : powers[eval];
+         }
+
+         *val = (float)(sign * num);
+         return ptr;
+      }
+
+      constexpr Kernels Table {
+         SkipWhitespace, SkipLine, SkipDigits, "scalar"
+      };
+
+   } // namespace Scanner::Scalar
+
+#if LANGULUS_SCANNER_X86
+   ///                                                                        
+   ///   SSE2 kernels, always available on x86-64                             
+   ///                                                                        
+   namespace SSE2
+   {
+
+      /// Find the first byte in a stream of 16-byte blocks, for which the    
+      /// predicate mask is set. Blocks are loaded unaligned, starting at     
+      /// ptr, so the block with the final newline reads at most 15 bytes     
+      /// past it, into the buffer padding                                    
+      ///   @param ptr - where to start scanning                              
+      ///   @param mask - returns a byte mask for a 16-byte block             
+      ///   @return a pointer to the first byte with a set mask               
+      template<class F>
+      inline const char* Find(const char* ptr, F&& mask) {
+         for (;; ptr += 16) {
+            const auto bits = static_cast<uint32_t>(mask(_mm_loadu_si128(
+               reinterpret_cast<const __m128i*>(ptr))));
+            if (bits)
+               return ptr + ::std::countr_zero(bits);
+         }
+      }
+
+      inline const char* SkipWhitespace(const char* ptr) {
+         // Whitespace runs in OBJ files are usually a single symbol    
+         if (not IsWhitespace(*ptr))
+            return ptr;
+
+         return Find(ptr + 1, [](__m128i v) {
+            const auto ws = _mm_or_si128(
+               _mm_or_si128(
+                  _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+               _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+            return ~_mm_movemask_epi8(ws) & 0xFFFF;
+         });
+      }
+
+      inline const char* SkipLine(const char* ptr) {
+         return Find(ptr, [](__m128i v) {
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+         }) + 1;
+      }
+
+      inline const char* SkipDigits(const char* ptr) {
+         if (not IsDigit(*ptr))
+            return ptr;
+
+         return Find(ptr + 1, [](__m128i v) {
+            const auto d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+            const auto digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+            return ~_mm_movemask_epi8(digit) & 0xFFFF;
+         });
+      }
+
+      constexpr Kernels Table {
+         SkipWhitespace, SkipLine, SkipDigits, "SSE2"
+      };
+
+   } // namespace Scanner::SSE2
+
+   ///                                                                        
+   ///   AVX2 kernels, used only if the CPU supports them                     
+   ///                                                                        
+   namespace AVX2
+   {
+
+      /// Same as SSE2::Find, but for 32-byte blocks, so it reads at most 31  
+      /// bytes past the final newline                                        
+      template<class F>
+      LANGULUS_SCANNER_AVX2
+      inline const char* Find(const char* ptr, F&& mask) {
+         for (;; ptr += 32) {
+            const auto bits = static_cast<uint32_t>(mask(_mm256_loadu_si256(
+               reinterpret_cast<const __m256i*>(ptr))));
+            if (bits)
+               return ptr + ::std::countr_zero(bits);
+         }
+      }
+
+      LANGULUS_SCANNER_AVX2
+      inline uint32_t NotWhitespace(__m256i v) {
+         const auto ws = _mm256_or_si256(
+            _mm256_or_si256(
+               _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+               _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+         return ~static_cast<uint32_t>(_mm256_movemask_epi8(ws));
+      }
+
+      LANGULUS_SCANNER_AVX2
+      inline uint32_t Newline(__m256i v) {
+         return static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+      }
+
+      LANGULUS_SCANNER_AVX2
+      inline uint32_t NotDigit(__m256i v) {
+         const auto d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+         const auto digit = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+         return ~static_cast<uint32_t>(_mm256_movemask_epi8(digit));
+      }
+
+      LANGULUS_SCANNER_AVX2
+      inline const char* SkipWhitespace(const char* ptr) {
+         // Whitespace runs in OBJ files are usually a single symbol    
+         if (not IsWhitespace(*ptr))
+            return ptr;
+         return Find(ptr + 1, NotWhitespace);
+      }
+
+      LANGULUS_SCANNER_AVX2
+      inline const char* SkipLine(const char* ptr) {
+         return Find(ptr, Newline) + 1;
+      }
+
+      LANGULUS_SCANNER_AVX2
+      inline const char* SkipDigits(const char* ptr) {
+         if (not IsDigit(*ptr))
+            return ptr;
+         return Find(ptr + 1, NotDigit);
+      }
+
+      constexpr Kernels Table {
+         SkipWhitespace, SkipLine, SkipDigits, "AVX2"
+      };
+
+   } // namespace Scanner::AVX2
+
+   /// Check if the CPU and the OS support AVX2                               
+   inline bool SupportsAVX2() {
+   #if defined(_MSC_VER) && !defined(__clang__)
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] < 7)
+         return false;
+
+      // OSXSAVE and AVX, and the OS saves YMM registers                
+      __cpuid(info, 1);
+      if ((info[2] & (1 << 27)) == 0 or (info[2] & (1 << 28)) == 0)
+         return false;
+      if ((_xgetbv(0) & 6) != 6)
+         return false;
+
+      __cpuidex(info, 7, 0);
+      return (info[1] & (1 << 5)) != 0;
+   #else
+      return __builtin_cpu_supports("avx2");
+   #endif
+   }
+#endif
+
+   /// Pick the best kernels for the CPU we're running on                     
+   ///   @return the kernel table                                             
+   inline const Kernels& Active() {
+      static const Kernels& active = [] () -> const Kernels& {
+      #if LANGULUS_SCANNER_X86
+         if (SupportsAVX2())
+            return AVX2::Table;
+         return SSE2::Table;
+      #else
+         return Scalar::Table;
+      #endif
+      }();
+      return active;
+   }
+
+   /// Convert up to eight digits at once, using SWAR arithmetic              
+   ///   @param ptr - the digits                                              
+   ///   @param count - number of digits, must be in the range [1; 8]         
+   ///   @return the parsed number                                            
+   inline uint64_t ParseDigits8(const char* ptr, unsigned count) {
+      // Left-pad with '0', so that the digits end up being the least   
+      // significant ones. Only the digits are read, never beyond them  
+      uint64_t v = 0x3030303030303030ull;
+      ::std::memcpy(reinterpret_cast<char*>(&v) + (8 - count), ptr, count);
+
+      v = (v & 0x0F0F0F0F0F0F0F0Full) * 2561 >> 8;
+      v = (v & 0x00FF00FF00FF00FFull) * 6553601 >> 16;
+      return (v & 0x0000FFFF0000FFFFull) * 42949672960001ull >> 32;
+   }
+
+   /// Convert up to sixteen digits                                           
+   ///   @param ptr - the digits                                              
+   ///   @param count - number of digits, must be in the range [0; 16]        
+   ///   @return the parsed number                                            
+   inline uint64_t ParseDigits(const char* ptr, unsigned count) {
+      constexpr uint64_t Scale[9] = {
+         1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+      };
+
+      if (count == 0)
+         return 0;
+      if (count <= 8)
+         return ParseDigits8(ptr, count);
+      return ParseDigits8(ptr, 8) * Scale[count - 8]
+           + ParseDigits8(ptr + 8, count - 8);
+   }
+
+   // Digit runs up to this length are converted exactly both as double 
+   // accumulation, and as integers, so both paths give the same result 
+   constexpr unsigned MaxExactDigits = 15;
+
+   // Powers of ten that are exactly representable as a double          
+   constexpr double EXACT_POWER_10[MaxExactDigits + 1] = {
+      1.0e0,  1.0e1,  1.0e2,  1.0e3,  1.0e4,  1.0e5,  1.0e6,  1.0e7,
+      1.0e8,  1.0e9,  1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15
+   };
+
+   /// Parse a signed integer, using the given kernels                        
+   ///   @param k - the kernels to use                                        
+   ///   @param ptr - data to scan                                            
+   ///   @param val - [out] the parsed number                                 
+   ///   @return a pointer to the first symbol after the number               
+   inline const char* ParseInt(const Kernels& k, const char* ptr, int* val) {
+      if (::std::endian::native != ::std::endian::little)
+         return Scalar::ParseInt(ptr, val);
+
+      const auto start = ptr;
+      const int sign = *ptr == '-' ? (++ptr, -1) : +1;
+      const auto end = k.SkipDigits(ptr);
+      const auto count = static_cast<unsigned>(end - ptr);
+
+      // Integers that might overflow are left to the reference path    
+      if (count > 9)
+         return Scalar::ParseInt(start, val);
+
+      *val = sign * static_cast<int>(ParseDigits(ptr, count));
+      return end;
+   }
+
+   /// Parse a floating point number, using the given kernels                 
+   ///   @param k - the kernels to use                                        
+   ///   @param ptr - data to scan, leading whitespace is skipped             
+   ///   @param val - [out] the parsed number                                 
+   ///   @return a pointer to the first symbol after the number               
+   inline const char* ParseFloat(const Kernels& k, const char* ptr, float* val) {
+      if (::std::endian::native != ::std::endian::little)
+         return Scalar::ParseFloat(ptr, val);
+
+      ptr = k.SkipWhitespace(ptr);
+      const auto start = ptr;
+
+      double sign = 1.0;
+      if (*ptr == '+')
+         ptr++;
+      else if (*ptr == '-') {
+         sign = -1.0;
+         ptr++;
+      }
+
+      // Integral part                                                  
+      const auto intEnd = k.SkipDigits(ptr);
+      const auto intCount = static_cast<unsigned>(intEnd - ptr);
+      if (intCount > MaxExactDigits)
+         return Scalar::ParseFloat(start, val);
+
+      double num = static_cast<double>(ParseDigits(ptr, intCount));
+      ptr = intEnd;
+      if (*ptr == '.')
+         ptr++;
+
+      // Fractional part                                                
+      const auto fraEnd = k.SkipDigits(ptr);
+      const auto fraCount = static_cast<unsigned>(fraEnd - ptr);
+      if (fraCount > MaxExactDigits)
+         return Scalar::ParseFloat(start, val);
+
+      const double fra = static_cast<double>(ParseDigits(ptr, fraCount));
+      num += fra / EXACT_POWER_10[fraCount];
+      ptr = fraEnd;
+
+      // Exponent                                                       
+      if (IsExponent(*ptr)) {
+         ptr++;
+
+         const double* powers = POWER_10_POS;
+         if (*ptr == '+')
+            ptr++;
+         else if (*ptr == '-') {
+            powers = POWER_10_NEG;
+            ptr++;
+         }
+
+         unsigned eval = 0;
+         while (IsDigit(*ptr))
+            eval = 10 * eval + (*ptr++ - '0');
+
+         num *= (eval >= MAX_POWER) ? 0.0 : powers[eval];
+      }
+
+      *val = static_cast<float>(sign * num);
+      return ptr;
+   }
+
+   /// Skip all whitespace forward, using the best available kernel           
+   inline const char* SkipWhitespace(const char* ptr) {
+      return Active().SkipWhitespace(ptr);
+   }
+
+   /// Skip forward until a new line begins, using the best available kernel  
+   inline const char* SkipLine(const char* ptr) {
+      return Active().SkipLine(ptr);
+   }
+
+   /// Parse a signed integer, using the best available kernels               
+   inline const char* ParseInt(const char* ptr, int* val) {
+      return ParseInt(Active(), ptr, val);
+   }
+
+   /// Parse a floating point number, using the best available kernels        
+   inline const char* ParseFloat(const char* ptr, float* val) {
+      return ParseFloat(Active(), ptr, val);
+   }
+
+} // namespace Scanner
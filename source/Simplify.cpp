@@ -0,0 +1,471 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Simplify.hpp"
+#include "Mesh.hpp"
+#include "Weld.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace Decimation {
+
+   /// Symmetric 4x4 matrix, that measures squared distance to a set of       
+   /// planes. Kept in double precision, because errors get accumulated       
+   struct Quadric {
+      double a2 = 0, ab = 0, ac = 0, ad = 0;
+      double b2 = 0, bc = 0, bd = 0;
+      double c2 = 0, cd = 0;
+      double d2 = 0;
+
+      void operator += (const Quadric& q) noexcept {
+         a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+         b2 += q.b2; bc += q.bc; bd += q.bd;
+         c2 += q.c2; cd += q.cd;
+         d2 += q.d2;
+      }
+
+      /// Squared distance of a point to the planes                           
+      double Error(const Vec3f& p) const noexcept {
+         const double x = p[0], y = p[1], z = p[2];
+         return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+              + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+              + c2 * z * z + 2 * cd * z
+              + d2;
+      }
+   };
+
+   /// A candidate half-edge collapse of vertex 'from' onto vertex 'to'       
+   struct Collapse {
+      double cost;
+      uint32_t from;
+      uint32_t to;
+   };
+
+   inline Vec3f Normal(const Vec3f& a, const Vec3f& b, const Vec3f& c) noexcept {
+      const float e1[3] {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+      const float e2[3] {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+      return {
+         e1[1] * e2[2] - e1[2] * e2[1],
+         e1[2] * e2[0] - e1[0] * e2[2],
+         e1[0] * e2[1] - e1[1] * e2[0]
+      };
+   }
+
+   inline float Dot(const Vec3f& a, const Vec3f& b) noexcept {
+      return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+   }
+
+   /// Hash the bits of a position, so that coincident vertices are found     
+   inline uint32_t Hash(const Vec3f& p) noexcept {
+      uint32_t bits[3];
+      ::std::memcpy(bits, &p[0], sizeof(float));
+      ::std::memcpy(bits + 1, &p[1], sizeof(float));
+      ::std::memcpy(bits + 2, &p[2], sizeof(float));
+      uint64_t h = bits[0] * 0x9E3779B97F4A7C15ull;
+      h ^= (h >> 32) ^ (bits[1] * 0xBF58476D1CE4E5B9ull);
+      h ^= (h >> 29) ^ (bits[2] * 0x94D049BB133111EBull);
+      return static_cast<uint32_t>(h ^ (h >> 32));
+   }
+
+   TMany<uint8_t> Lock(const TMany<Vec3f>&, const TMany<uint32_t>&);
+
+   /// Copy a committed stream, if it is of the given type                    
+   ///   @param stream - the stream, can be nullptr                           
+   ///   @param to - [out] where to copy the stream                           
+   template<class T>
+   void Copy(const Many* stream, TMany<T>& to) {
+      if (not stream or stream->IsEmpty() or not stream->template IsExact<T>())
+         return;
+
+      to.template Reserve<true>(stream->GetCount());
+      ::std::memcpy(static_cast<void*>(to.GetRaw()),
+         stream->GetRaw(), stream->GetBytesize());
+   }
+
+} // namespace Decimation
+
+
+/// Find the vertices that must not be collapsed, so that the silhouette      
+/// and the attribute discontinuities of the mesh are preserved. These are    
+/// the vertices on borders and non-manifold edges, and the vertices that     
+/// share their position with other vertices, which happens on UV and         
+/// normal seams of welded meshes                                             
+///   @param positions - vertex positions                                     
+///   @param indices - triangle list indices                                  
+///   @return a flag for each vertex, nonzero if locked                       
+TMany<uint8_t> Decimation::Lock(
+   const TMany<Vec3f>& positions, const TMany<uint32_t>& indices
+) {
+   constexpr uint32_t Empty = ~uint32_t {0};
+   const auto vertices = positions.GetCount();
+
+   TMany<uint8_t> locked;
+   locked.Reserve<true>(vertices);
+   for (auto& l : locked)
+      l = 0;
+
+   // Map each vertex to the first vertex with the same position        
+   Count capacity = 16;
+   while (capacity < vertices * 2)
+      capacity <<= 1;
+
+   TMany<uint32_t> table;
+   table.Reserve<true>(capacity);
+   for (auto& t : table)
+      t = Empty;
+
+   TMany<uint32_t> position;
+   position.Reserve<true>(vertices);
+   for (Offset v = 0; v < vertices; ++v) {
+      auto slot = Hash(positions[v]) & (capacity - 1);
+      while (table[slot] != Empty
+      and ::std::memcmp(&positions[table[slot]], &positions[v], sizeof(Vec3f)))
+         slot = (slot + 1) & (capacity - 1);
+
+      if (table[slot] == Empty) {
+         table[slot] = static_cast<uint32_t>(v);
+         position[v] = static_cast<uint32_t>(v);
+      }
+      else {
+         // A seam - lock both sides of it                              
+         position[v] = table[slot];
+         locked[v] = 1;
+         locked[table[slot]] = 1;
+      }
+   }
+
+   // Count the triangles around each edge between positions            
+   const auto edges = indices.GetCount();
+   capacity = 16;
+   while (capacity < edges * 2)
+      capacity <<= 1;
+
+   TMany<uint64_t> keys;
+   keys.Reserve<true>(capacity);
+   for (auto& k : keys)
+      k = ~uint64_t {0};
+
+   TMany<uint32_t> counts;
+   counts.Reserve<true>(capacity);
+
+   for (Offset i = 0; i < edges; ++i) {
+      auto a = position[indices[i]];
+      auto b = position[indices[i - i % 3 + (i + 1) % 3]];
+      if (a > b)
+         ::std::swap(a, b);
+
+      const uint64_t key = (uint64_t {a} << 32) | b;
+      auto slot = static_cast<Offset>((key * 0x9E3779B97F4A7C15ull) >> 32) & (capacity - 1);
+      while (keys[slot] != ~uint64_t {0} and keys[slot] != key)
+         slot = (slot + 1) & (capacity - 1);
+
+      if (keys[slot] != key) {
+         keys[slot] = key;
+         counts[slot] = 0;
+      }
+      ++counts[slot];
+   }
+
+   // Lock the ends of edges, that don't have exactly two triangles     
+   for (Offset slot = 0; slot < capacity; ++slot) {
+      if (keys[slot] == ~uint64_t {0} or counts[slot] == 2)
+         continue;
+
+      const auto a = static_cast<uint32_t>(keys[slot] >> 32);
+      const auto b = static_cast<uint32_t>(keys[slot]);
+      locked[a] = locked[b] = 1;
+   }
+
+   // Propagate the locks to all vertices at a locked position          
+   for (Offset v = 0; v < vertices; ++v) {
+      if (locked[position[v]])
+         locked[v] = 1;
+   }
+
+   return locked;
+}
+
+/// Reduce the number of triangles by collapsing edges, cheapest first        
+/// Collapses are done in passes - each pass sorts all candidates by their    
+/// error, and collapses as many as possible without flipping a triangle,     
+/// or changing any triangle twice                                            
+///   @param positions - vertex positions                                     
+///   @param indices - triangle list indices                                  
+///   @param target - desired number of indices                               
+///   @return the simplified triangle list, indexing the same vertices        
+TMany<uint32_t> Decimation::Decimate(
+   const TMany<Vec3f>& positions, const TMany<uint32_t>& indices, Count target
+) {
+   const auto vertices = positions.GetCount();
+   const auto locked = Lock(positions, indices);
+
+   // Accumulate the area-weighted plane of each triangle in its corners
+   TMany<Quadric> quadrics;
+   quadrics.Reserve<true>(vertices);
+   for (auto& q : quadrics)
+      q = {};
+
+   TMany<uint32_t> result;
+   result.Reserve(indices.GetCount());
+   for (Offset i = 0; i + 2 < indices.GetCount(); i += 3) {
+      const uint32_t t[3] {indices[i], indices[i + 1], indices[i + 2]};
+      if (t[0] == t[1] or t[1] == t[2] or t[0] == t[2])
+         continue;
+
+      result << t[0] << t[1] << t[2];
+
+      const auto n = Normal(positions[t[0]], positions[t[1]], positions[t[2]]);
+      const double length = ::std::sqrt(double {Dot(n, n)});
+      if (length <= 0)
+         continue;
+
+      // Plane quadric is scaled by the triangle area, which is half    
+      // the length of the unnormalized normal                          
+      const double a = n[0] / length, b = n[1] / length, c = n[2] / length;
+      const double d = -(a * positions[t[0]][0] + b * positions[t[0]][1] + c * positions[t[0]][2]);
+      const double w = length * 0.5;
+      Quadric q;
+      q.a2 = w * a * a; q.ab = w * a * b; q.ac = w * a * c; q.ad = w * a * d;
+      q.b2 = w * b * b; q.bc = w * b * c; q.bd = w * b * d;
+      q.c2 = w * c * c; q.cd = w * c * d;
+      q.d2 = w * d * d;
+
+      quadrics[t[0]] += q;
+      quadrics[t[1]] += q;
+      quadrics[t[2]] += q;
+   }
+
+   TMany<uint32_t> offsets, adjacency, remap;
+   TMany<uint8_t> touched;
+   TMany<Collapse> collapses;
+   offsets.Reserve<true>(vertices + 1);
+   remap.Reserve<true>(vertices);
+   touched.Reserve<true>(vertices);
+
+   while (result.GetCount() > target) {
+      const auto triangles = result.GetCount() / 3;
+
+      // Triangles around each vertex, in compressed row form           
+      for (auto& o : offsets)
+         o = 0;
+      for (auto i : result)
+         ++offsets[i + 1];
+      for (Offset v = 0; v < vertices; ++v)
+         offsets[v + 1] += offsets[v];
+
+      adjacency.Clear();
+      adjacency.Reserve<true>(result.GetCount());
+      for (Offset v = 0; v < vertices; ++v)
+         remap[v] = offsets[v];
+      for (Offset i = 0; i < result.GetCount(); ++i)
+         adjacency[remap[result[i]]++] = static_cast<uint32_t>(i / 3);
+
+      // Gather candidate collapses along each triangle edge, in the    
+      // cheaper direction that isn't locked                            
+      collapses.Clear();
+      for (Offset i = 0; i < result.GetCount(); ++i) {
+         const auto a = result[i];
+         const auto b = result[i - i % 3 + (i + 1) % 3];
+         if (locked[a] and locked[b])
+            continue;
+
+         auto q = quadrics[a];
+         q += quadrics[b];
+         const auto ab = locked[a] ? -1.0 : q.Error(positions[b]);
+         const auto ba = locked[b] ? -1.0 : q.Error(positions[a]);
+         if (ba < 0 or (ab >= 0 and ab <= ba))
+            collapses << Collapse {ab, a, b};
+         else
+            collapses << Collapse {ba, b, a};
+      }
+
+      ::std::sort(collapses.GetRaw(), collapses.GetRaw() + collapses.GetCount(),
+         [](const Collapse& l, const Collapse& r) { return l.cost < r.cost; });
+
+      for (Offset v = 0; v < vertices; ++v) {
+         remap[v] = static_cast<uint32_t>(v);
+         touched[v] = 0;
+      }
+
+      // Collapse, until enough triangles are gone                      
+      Count removed = 0;
+      Count collapsed = 0;
+      for (const auto& c : collapses) {
+         if (touched[c.from] or touched[c.to])
+            continue;
+
+         // Reject collapses that would flip a triangle around 'from'   
+         Count degenerate = 0;
+         bool flips = false;
+         for (auto a = offsets[c.from]; a < offsets[c.from + 1] and not flips; ++a) {
+            const auto t = result.GetRaw() + adjacency[a] * 3;
+            if (t[0] == c.to or t[1] == c.to or t[2] == c.to) {
+               ++degenerate;
+               continue;
+            }
+
+            const auto& p0 = positions[t[0] == c.from ? c.to : t[0]];
+            const auto& p1 = positions[t[1] == c.from ? c.to : t[1]];
+            const auto& p2 = positions[t[2] == c.from ? c.to : t[2]];
+            // Turning by more than ~75 degrees counts as a flip, so    
+            // that triangles can't flip gradually over several passes  
+            const auto before = Normal(positions[t[0]], positions[t[1]], positions[t[2]]);
+            const auto after = Normal(p0, p1, p2);
+            flips = Dot(before, after) <= 0.25f * ::std::sqrt(Dot(before, before) * Dot(after, after));
+         }
+
+         if (flips)
+            continue;
+
+         remap[c.from] = c.to;
+         quadrics[c.to] += quadrics[c.from];
+
+         // Triangles around 'from' are changing, so their vertices     
+         // can't be collapsed until the next pass                      
+         touched[c.to] = 1;
+         for (auto a = offsets[c.from]; a < offsets[c.from + 1]; ++a) {
+            const auto t = result.GetRaw() + adjacency[a] * 3;
+            touched[t[0]] = touched[t[1]] = touched[t[2]] = 1;
+         }
+
+         removed += degenerate;
+         ++collapsed;
+
+         if ((triangles - removed) * 3 <= target)
+            break;
+      }
+
+      if (not collapsed)
+         break;
+
+      // Apply the collapses, and drop the triangles that degenerated   
+      Offset write = 0;
+      for (Offset i = 0; i < result.GetCount(); i += 3) {
+         const auto a = remap[result[i]];
+         const auto b = remap[result[i + 1]];
+         const auto c = remap[result[i + 2]];
+         if (a == b or b == c or a == c)
+            continue;
+
+         result[write++] = a;
+         result[write++] = b;
+         result[write++] = c;
+      }
+
+      TMany<uint32_t> compacted;
+      compacted.Reserve<true>(write);
+      ::std::memcpy(compacted.GetRaw(), result.GetRaw(), write * sizeof(uint32_t));
+      result = Move(compacted);
+   }
+
+   return result;
+}
+
+/// Simplify the committed mesh in place, replacing all of its data with a    
+/// decimated, welded triangle list                                           
+///   @param level - each level halves the number of triangles                
+void Mesh::Simplify(Count level) {
+   if (not level
+   or not mView.mTopology
+   or mView.mTopology->CastsTo<A::TriangleStrip>()
+   or not mView.mTopology->CastsTo<A::Triangle>())
+      return;
+
+   auto positions = GatherPositions();
+   auto indices = GatherIndices();
+   TMany<Vec3f> normals;
+   TMany<Vec2f> texcoords;
+   TMany<Vec3f> colors;
+   Decimation::Copy(GetData<Traits::Aim>(), normals);
+   Decimation::Copy(GetData<Traits::Sampler>(), texcoords);
+   Decimation::Copy(GetData<Traits::Color>(), colors);
+
+   if (GetData<Traits::Index>(1)) {
+      // Separately indexed attributes have to be welded first, so that 
+      // seams become visible to the simplifier                         
+      auto welded = Weld::Unify(
+         positions, normals, texcoords, colors,
+         GatherIndices(0), GatherIndices(1), GatherIndices(2)
+      );
+
+      positions = Move(welded.positions);
+      normals   = Move(welded.normals);
+      texcoords = Move(welded.texcoords);
+      colors    = Move(welded.colors);
+      indices   = Move(welded.indices);
+   }
+
+   if (indices.GetCount() < 3 or positions.IsEmpty())
+      return;
+
+   const auto target = ::std::max(Count {1}, (indices.GetCount() / 3) >> level) * 3;
+   const auto original = indices.GetCount();
+   indices = Decimation::Decimate(positions, indices, target);
+
+   // Keep only the vertices that are still in use                      
+   constexpr uint32_t Unused = ~uint32_t {0};
+   TMany<uint32_t> remap;
+   remap.Reserve<true>(positions.GetCount());
+   for (auto& r : remap)
+      r = Unused;
+
+   TMany<Vec3f> outPositions, outNormals, outColors;
+   TMany<Vec2f> outTexcoords;
+   for (auto& i : indices) {
+      auto& r = remap[i];
+      if (r == Unused) {
+         r = static_cast<uint32_t>(outPositions.GetCount());
+         outPositions << positions[i];
+         if (i < normals.GetCount())
+            outNormals << normals[i];
+         if (i < texcoords.GetCount())
+            outTexcoords << texcoords[i];
+         if (i < colors.GetCount())
+            outColors << colors[i];
+      }
+      i = r;
+   }
+
+   mDataListMap.Reset();
+   mView.mPrimitiveCount = static_cast<uint32_t>(indices.GetCount() / 3);
+   mView.mIndexCount = static_cast<uint32_t>(indices.GetCount());
+
+   Commit<Traits::Place>(Abandon(outPositions));
+   if (outNormals)
+      Commit<Traits::Aim>(Abandon(outNormals));
+   if (outTexcoords)
+      Commit<Traits::Sampler>(Abandon(outTexcoords));
+   if (outColors)
+      Commit<Traits::Color>(Abandon(outColors));
+
+   Commit<Traits::Index>(Abandon(indices));
+
+   Logger::Verbose(Self(), "Simplified to level ", level, ": ",
+      original / 3, " -> ", mView.mPrimitiveCount, " triangles");
+}
+
+/// Generate a level of detail for a file-based mesh. Levels further away     
+/// are simplified versions of the file, each level halving the triangles     
+///   @param model - the mesh to generate LOD for                             
+///   @param lod - the LOD state to generate                                  
+///   @return a descriptor for the LOD mesh                                   
+auto Mesh::SimplifiedDetail(const Mesh* model, const LOD& lod) -> Construct {
+   auto& md = model->GetDescriptor();
+   if (lod.mLODIndex >= 0) {
+      // Closer levels would require more detail than the file has      
+      return Construct::From<A::Mesh>(md);
+   }
+
+   // Levels accumulate, if this mesh is already simplified             
+   auto newMesh = md;
+   newMesh.SetTrait(Traits::Simplify {
+      model->mSimplify + static_cast<Count>(::std::round(-lod.mLODIndex))
+   });
+   return Construct::From<A::Mesh>(Abandon(newMesh));
+}
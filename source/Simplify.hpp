@@ -0,0 +1,23 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+
+
+///                                                                           
+///   Mesh simplification                                                     
+///                                                                           
+/// Quadric error metric edge collapse, as described by Garland and           
+/// Heckbert. Collapses are half-edge ones, moving a vertex onto one of its   
+/// neighbours, so that no new vertices or attributes are ever interpolated   
+///                                                                           
+namespace Decimation {
+
+   TMany<uint32_t> Decimate(const TMany<Vec3f>&, const TMany<uint32_t>&, Count target);
+
+} // namespace Decimation
@@ -0,0 +1,102 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Streams.hpp"
+#include <cstring>
+
+
+/// Hash everything the generated data depends on                             
+///   @return the hash                                                        
+auto StreamCache::Key::GetHash() const -> uint64_t {
+   constexpr uint64_t K0 = 0x9E3779B97F4A7C15ull;
+   constexpr uint64_t K1 = 0xBF58476D1CE4E5B9ull;
+   uint64_t h = K0;
+
+   const auto mix = [&](const void* value, size_t size) {
+      uint64_t word = 0;
+      ::std::memcpy(&word, value, size);
+      h ^= word * K0;
+      h = (h << 31) | (h >> 33);
+      h *= K1;
+   };
+
+   mix(&mGenerator, sizeof(mGenerator));
+   mix(&mPrimitive, sizeof(mPrimitive));
+   mix(&mTopology, sizeof(mTopology));
+   mix(&mTrait, sizeof(mTrait));
+
+   const uint64_t options = mTesselation
+      | (uint64_t {mMapping} << 32)
+      | (uint64_t {mOptimized} << 63);
+   mix(&options, sizeof(options));
+
+   h ^= h >> 29;
+   return h ^ (h >> 32);
+}
+
+/// Find the data a generator has already made for an identical mesh          
+///   @param key - what the data depends on                                   
+///   @param streams - [out] the shared data lists, if found                  
+///   @return true if data was found                                          
+bool StreamCache::Find(const Key& key, Streams& streams) {
+   ::std::lock_guard lock {mMutex};
+   const auto found = mEntries.FindIt(key.GetHash());
+   if (not found or not (found.GetValue().mKey == key))
+      return false;
+
+   streams = found.GetValue().mStreams;
+   return true;
+}
+
+/// Share the data a generator has made with later identical meshes           
+///   @param key - what the data depends on                                   
+///   @param streams - the data lists the generator committed                 
+void StreamCache::Insert(const Key& key, const Streams& streams) {
+   if (streams.IsEmpty())
+      return;
+
+   ::std::lock_guard lock {mMutex};
+   const auto hash = key.GetHash();
+   const auto found = mEntries.FindIt(hash);
+   if (found) {
+      // Either another mesh made the same data in the meantime, or     
+      // it is a hash collision - newest data wins in both cases        
+      found.GetValue() = Entry {key, streams};
+   }
+   else mEntries.Insert(hash, Entry {key, streams});
+}
+
+/// Release all shared data                                                   
+void StreamCache::Reset() {
+   ::std::lock_guard lock {mMutex};
+   mEntries.Reset();
+}
+
+/// Release shared data that no mesh uses anymore - the cache holding the     
+/// only reference to it                                                      
+///   @return the number of bytes released                                    
+auto StreamCache::Prune() -> Count {
+   ::std::lock_guard lock {mMutex};
+   TUnorderedMap<uint64_t, Entry> kept;
+   Count released = 0;
+   for (auto pair : mEntries) {
+      bool used = false;
+      Count bytes = 0;
+      for (auto& stream : pair.mValue.mStreams) {
+         used |= stream.mData.GetUses() > 1;
+         bytes += stream.mData.GetBytesize();
+      }
+
+      if (used)
+         kept.Insert(pair.mKey, pair.mValue);
+      else
+         released += bytes;
+   }
+
+   mEntries = Abandon(kept);
+   return released;
+}
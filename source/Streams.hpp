@@ -0,0 +1,64 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <mutex>
+
+
+///                                                                           
+///   Shared generated streams                                                
+///                                                                           
+/// A content-addressed cache of generated data, owned by the MeshLibrary.    
+/// Generated data depends only on the generator function, the primitive,     
+/// the topology, the tesselation and the texture mapping. So meshes that     
+/// differ only in other traits, like a material, generate identical data.    
+/// The first such mesh generates it, and the rest commit the cached data     
+/// lists instead. Containers are reference-counted, so the memory is shared, 
+/// and must never be modified in place                                       
+///                                                                           
+struct StreamCache {
+   using FGenerator = void(*)(Mesh*);
+
+   /// Everything that the data of a generator depends on                     
+   struct Key {
+      FGenerator mGenerator;
+      DMeta      mPrimitive;
+      DMeta      mTopology;
+      TMeta      mTrait;
+      uint32_t   mTesselation;
+      uint32_t   mMapping;
+      bool       mOptimized;
+
+      bool operator == (const Key&) const = default;
+      auto GetHash() const -> uint64_t;
+   };
+
+   /// A data list committed by a generator, and how to commit it again       
+   struct Stream {
+      TMeta mTrait;
+      void (*mCommit)(Mesh*, const Many&);
+      Many  mData;
+   };
+
+   /// Data lists committed by a single run of a generator, in order          
+   using Streams = TMany<Stream>;
+
+   bool Find(const Key&, Streams&);
+   void Insert(const Key&, const Streams&);
+   void Reset();
+   auto Prune() -> Count;
+
+private:
+   struct Entry {
+      Key     mKey;
+      Streams mStreams;
+   };
+
+   ::std::mutex mMutex;
+   TUnorderedMap<uint64_t, Entry> mEntries;
+};
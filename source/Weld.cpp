@@ -0,0 +1,146 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Weld.hpp"
+#include <cstring>
+
+
+namespace Weld {
+
+   /// Marks an unused slot in the hash table                                 
+   constexpr uint32_t Empty = ~uint32_t {0};
+
+   /// Hash a tuple of attribute indices                                      
+   ///   @param p - position index                                            
+   ///   @param n - normal index                                              
+   ///   @param t - texture coordinate index                                  
+   ///   @return the hash                                                     
+   inline uint32_t Hash(uint32_t p, uint32_t n, uint32_t t) noexcept {
+      uint64_t h = p * 0x9E3779B97F4A7C15ull;
+      h ^= (h >> 32) ^ (n * 0xBF58476D1CE4E5B9ull);
+      h ^= (h >> 29) ^ (t * 0x94D049BB133111EBull);
+      return static_cast<uint32_t>(h ^ (h >> 32));
+   }
+
+} // namespace Weld
+
+
+/// Unify separately indexed vertex attributes under a single index buffer.   
+/// Each distinct (position, normal, texture coordinate) index tuple becomes  
+/// one vertex, found via an open-addressing hash table with linear probing.  
+/// The table is sized from the number of indices, so it never grows, and     
+/// is kept at most half full                                                 
+///   @param positions - the positions                                        
+///   @param normals - the normals                                            
+///   @param texcoords - the texture coordinates                              
+///   @param colors - the vertex colors, one for each position, if any        
+///   @param positionIndices - an index into positions for each vertex        
+///   @param normalIndices - an index into normals for each vertex            
+///   @param textureIndices - an index into texcoords for each vertex         
+///   @param layout - if provided, vertices are also written interleaved      
+///      in this layout as they're welded, without another pass               
+///   @return the welded vertices and their indices                           
+Weld::Result Weld::Unify(
+   const TMany<Vec3f>& positions,
+   const TMany<Vec3f>& normals,
+   const TMany<Vec2f>& texcoords,
+   const TMany<Vec3f>& colors,
+   const TMany<uint32_t>& positionIndices,
+   const TMany<uint32_t>& normalIndices,
+   const TMany<uint32_t>& textureIndices,
+   const VertexLayout* layout
+) {
+   const auto count = positionIndices.GetCount();
+   LANGULUS_ASSERT(normalIndices.GetCount() == count
+               and textureIndices.GetCount() == count, Mesh,
+      "Attribute index streams must be of the same size");
+
+   Result result;
+   if (not count)
+      return result;
+
+   Count capacity = 16;
+   while (capacity < count * 2)
+      capacity <<= 1;
+   const Count mask = capacity - 1;
+
+   TMany<uint32_t> table;
+   table.Reserve<true>(capacity);
+   ::std::memset(table.GetRaw(), 0xFF, capacity * sizeof(uint32_t));
+
+   // Remember the original index tuple for each welded vertex, so that 
+   // collisions can be resolved without comparing attribute values     
+   TMany<uint32_t> tuples;
+   tuples.Reserve(count * 3);
+
+   result.indices.Reserve<true>(count);
+   result.positions.Reserve(count);
+   result.normals.Reserve(count);
+   result.texcoords.Reserve(count);
+
+   // Colors belong to positions, so they're welded along with them,    
+   // and missing ones are white                                        
+   const bool hasColors = colors.GetCount() > 0;
+   if (hasColors)
+      result.colors.Reserve(count);
+
+   if (layout) {
+      result.interleaved.Reserve<true>(count * layout->mStride);
+      ::std::memset(result.interleaved.GetRaw(), 0, count * layout->mStride);
+   }
+
+   const bool hasNormals = normals.GetCount() > 0;
+   const bool hasTexcoords = texcoords.GetCount() > 0;
+
+   for (Offset i = 0; i < count; ++i) {
+      const auto p = positionIndices[i];
+      const auto n = normalIndices[i];
+      const auto t = textureIndices[i];
+
+      auto slot = Hash(p, n, t) & mask;
+      for (;;) {
+         const auto vertex = table[slot];
+         if (vertex == Empty) {
+            // A new unique vertex                                      
+            const auto fresh = static_cast<uint32_t>(result.positions.GetCount());
+            table[slot] = fresh;
+            tuples << p << n << t;
+
+            result.positions << positions[p];
+            result.normals   << (hasNormals   ? normals[n]   : Vec3f {0, 0, 1});
+            result.texcoords << (hasTexcoords ? texcoords[t] : Vec2f {});
+            if (hasColors)
+               result.colors << (p < colors.GetCount() ? colors[p] : Vec3f {1, 1, 1});
+            result.indices[i] = fresh;
+
+            if (layout) {
+               const auto vertex = result.interleaved.GetRaw() + fresh * layout->mStride;
+               layout->Write(vertex, VertexLayout::Position, &result.positions[fresh]);
+               layout->Write(vertex, VertexLayout::Normal,   &result.normals[fresh]);
+               layout->Write(vertex, VertexLayout::Sampler,  &result.texcoords[fresh]);
+               if (hasColors)
+                  layout->Write(vertex, VertexLayout::Color, &result.colors[fresh]);
+            }
+            break;
+         }
+
+         const auto tuple = tuples.GetRaw() + vertex * 3;
+         if (tuple[0] == p and tuple[1] == n and tuple[2] == t) {
+            // Vertex was already seen                                  
+            result.indices[i] = vertex;
+            break;
+         }
+
+         slot = (slot + 1) & mask;
+      }
+   }
+
+   // Trim the interleaved vertices to the welded ones                  
+   if (layout)
+      result.interleaved.Reserve<true>(result.positions.GetCount() * layout->mStride);
+   return result;
+}
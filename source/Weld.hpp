@@ -0,0 +1,45 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include "Interleave.hpp"
+
+
+///                                                                           
+///   Vertex welding                                                          
+///                                                                           
+/// File formats like OBJ index every vertex attribute separately, while      
+/// GPUs consume a single index buffer. Welding finds each unique tuple of    
+/// attribute indices, and turns it into a vertex of its own                  
+///                                                                           
+namespace Weld {
+
+   /// Vertex attributes, unified under a single index buffer                 
+   struct Result {
+      TMany<Vec3f>    positions;
+      TMany<Vec3f>    normals;
+      TMany<Vec2f>    texcoords;
+      TMany<Vec3f>    colors;
+      TMany<uint32_t> indices;
+
+      // The same vertices interleaved, if a layout was provided        
+      Bytes           interleaved;
+   };
+
+   Result Unify(
+      const TMany<Vec3f>& positions,
+      const TMany<Vec3f>& normals,
+      const TMany<Vec2f>& texcoords,
+      const TMany<Vec3f>& colors,
+      const TMany<uint32_t>& positionIndices,
+      const TMany<uint32_t>& normalIndices,
+      const TMany<uint32_t>& textureIndices,
+      const VertexLayout* layout = nullptr
+   );
+
+} // namespace Weld
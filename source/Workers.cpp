@@ -0,0 +1,131 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Workers.hpp"
+#include <algorithm>
+#include <memory>
+
+
+/// Finish all tasks and join the threads                                     
+Workers::~Workers() {
+   Stop();
+}
+
+/// Schedule a task, starting the threads if not started yet                  
+///   @param task - the task to run in the background                         
+void Workers::Push(Task&& task) {
+   {
+      ::std::lock_guard lock {mMutex};
+      LANGULUS_ASSERT(not mStopping, Mesh,
+         "Can't schedule tasks after workers have stopped");
+
+      if (mThreads.empty()) {
+         // Leave a core for the thread that pushes the tasks           
+         const auto cores = ::std::thread::hardware_concurrency();
+         const auto count = cores > 1 ? cores - 1 : 1;
+         mThreads.reserve(count);
+         for (unsigned i = 0; i < count; ++i)
+            mThreads.emplace_back([this] { Work(); });
+      }
+
+      mTasks.push_back(::std::move(task));
+   }
+
+   mWake.notify_one();
+}
+
+/// Run a task for each index, concurrently, and wait for all of them. The    
+/// calling thread works on the indices too, and workers that get to the      
+/// task after all indices are taken just skip it, so this never waits on     
+/// tasks that haven't started - it's safe to call from a worker. Rethrows    
+/// the first exception that occured                                          
+///   @param count - number of indices                                        
+///   @param task - the task to run for each index                            
+void Workers::ForEach(Count count, const ::std::function<void(Offset)>& task) {
+   struct Progress {
+      ::std::atomic<Offset> mNext {};
+      ::std::atomic<Count> mDone {};
+      ::std::mutex mMutex;
+      ::std::exception_ptr mError;
+   };
+
+   // Helpers might start after this function returns, so the progress  
+   // is shared, and the task is touched only while indices are left    
+   const auto progress = ::std::make_shared<Progress>();
+   const auto work = [progress, &task, count] {
+      Offset i;
+      while ((i = progress->mNext++) < count) {
+         try { task(i); }
+         catch (...) {
+            ::std::lock_guard lock {progress->mMutex};
+            if (not progress->mError)
+               progress->mError = ::std::current_exception();
+         }
+
+         if (++progress->mDone == count)
+            progress->mDone.notify_all();
+      }
+   };
+
+   if (count > 1) {
+      Count helpers;
+      {
+         ::std::lock_guard lock {mMutex};
+         helpers = mStopping ? 0 : ::std::max<Count>(mThreads.size(), 1);
+      }
+
+      for (Count i = 0; i < ::std::min(helpers, count - 1); ++i)
+         Push(work);
+   }
+
+   work();
+
+   for (auto done = progress->mDone.load(); done < count; done = progress->mDone.load())
+      progress->mDone.wait(done);
+
+   if (progress->mError)
+      ::std::rethrow_exception(progress->mError);
+}
+
+/// Finish all pending tasks and join the threads. No tasks can be pushed     
+/// afterwards                                                                
+void Workers::Stop() {
+   {
+      ::std::lock_guard lock {mMutex};
+      if (mStopping)
+         return;
+      mStopping = true;
+   }
+
+   mWake.notify_all();
+   for (auto& thread : mThreads)
+      thread.join();
+   mThreads.clear();
+}
+
+/// Run tasks until stopped and no tasks are left                             
+void Workers::Work() {
+   while (true) {
+      Task task;
+      {
+         ::std::unique_lock lock {mMutex};
+         mWake.wait(lock, [this] {
+            return mStopping or not mTasks.empty();
+         });
+
+         if (mTasks.empty())
+            return;
+
+         task = ::std::move(mTasks.front());
+         mTasks.pop_front();
+      }
+
+      // Tasks report their own errors, a worker must never die         
+      try { task(); }
+      catch (...) {}
+   }
+}
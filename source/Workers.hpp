@@ -0,0 +1,45 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <vector>
+
+
+///                                                                           
+///   Background workers                                                      
+///                                                                           
+/// A pool of threads, owned by the MeshLibrary, that loads meshes in the     
+/// background. Threads are started with the first task, so libraries that    
+/// never load asynchronously don't pay for them. Tasks are run in the order  
+/// they were pushed, and all pending tasks are finished when the pool is     
+/// stopped, because meshes wait on their own loading upon destruction        
+///                                                                           
+struct Workers {
+   using Task = ::std::function<void()>;
+
+   ~Workers();
+
+   void Push(Task&&);
+   void ForEach(Count, const ::std::function<void(Offset)>&);
+   void Stop();
+
+private:
+   void Work();
+
+   ::std::mutex mMutex;
+   ::std::condition_variable mWake;
+   ::std::deque<Task> mTasks;
+   ::std::vector<::std::thread> mThreads;
+   bool mStopping = false;
+};
@@ -186,6 +186,16 @@ auto GenerateBox<T, TOPOLOGY>::Detail(const Mesh* model, const LOD&) -> Construc
 GENERATE() Positions(Mesh* model) {
    TMany<PointType> data = D::Vertices;
    model->Commit<Traits::Place>(Abandon(data));
+
+   // The box fills its bounds, so they're known in closed form         
+   constexpr float h = 0.5f;
+   constexpr float depth = Dimensions >= 3 ? h : 0;
+   constexpr float area = not CT::Triangle<TOPOLOGY> ? 0
+      : Dimensions >= 3 ? 6 : 1;
+
+   TMany<MeshBounds> bounds;
+   bounds << MeshBounds::FromBox({-h, -h, -depth}, {h, h, depth}, area);
+   model->template Commit<Traits::Bounds>(Abandon(bounds));
 }
 
 /// Generate normals for a box                                                
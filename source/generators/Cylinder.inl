@@ -136,6 +136,13 @@ GENERATE() Positions(Mesh* model) {
       for (Offset i = 0; i < TriangleCount; ++i)
          data << E {Vertices, TriangleIndices[i]};
       model->Commit<Traits::Place>(Abandon(data));
+
+      // The cylinder is made of the faces of a unit box, so its bounds 
+      // are known in closed form                                       
+      constexpr float h = 0.5f;
+      TMany<MeshBounds> bounds;
+      bounds << MeshBounds::FromBox({-h, -h, -h}, {h, h, h}, 6);
+      model->Commit<Traits::Bounds>(Abandon(bounds));
    }
    else if constexpr (CT::Line<TOPOLOGY>) {
       // A cylinder made out of lines                                   
@@ -198,6 +198,17 @@ GENERATE() Positions(Mesh* model) {
       model->Commit<Traits::Place>(Abandon(data));
    }
    else static_assert(false, "Unsupported topology for box positions");
+
+   // The frustum is made of the vertices of a unit box, so its bounds  
+   // are known in closed form                                          
+   constexpr float h = 0.5f;
+   constexpr float depth = Dimensions >= 3 ? h : 0;
+   constexpr float area = not CT::Triangle<TOPOLOGY> ? 0
+      : Dimensions >= 3 ? 6 : 1;
+
+   TMany<MeshBounds> bounds;
+   bounds << MeshBounds::FromBox({-h, -h, -depth}, {h, h, depth}, area);
+   model->Commit<Traits::Bounds>(Abandon(bounds));
 }
 
 /// Generate normals for a frustum                                            
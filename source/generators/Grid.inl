@@ -102,6 +102,14 @@ GENERATE() Positions(Mesh* model) {
       }
 
       model->Commit<Traits::Place>(Abandon(data));
+
+      // Lines span the whole grid, so its bounds are known in closed   
+      // form                                                           
+      constexpr float h = 0.5f;
+      constexpr float depth = Dimensions >= 3 ? h : 0;
+      TMany<MeshBounds> bounds;
+      bounds << MeshBounds::FromBox({-h, -h, -depth}, {h, h, depth}, 0);
+      model->Commit<Traits::Bounds>(Abandon(bounds));
    }
    else if constexpr (CT::Point<TOPOLOGY>) {
       // Generate a grid of points                                      
@@ -131,6 +139,17 @@ GENERATE() Positions(Mesh* model) {
       }
 
       model->Commit<Traits::Place>(Abandon(data));
+
+      // Points start at the near corner of each cell, so the last ones 
+      // are a cell short of the far side of the grid                   
+      const Vec3f min {-0.5f, -0.5f, Dimensions >= 3 ? -0.5f : 0};
+      Vec3f max;
+      for (Offset c = 0; c < Dimensions and c < 3; ++c)
+         max[c] = static_cast<float>(steps[c] - 1) / static_cast<float>(steps[c]) - 0.5f;
+
+      TMany<MeshBounds> bounds;
+      bounds << MeshBounds::FromBox(min, max, 0);
+      model->Commit<Traits::Bounds>(Abandon(bounds));
    }
 }
 
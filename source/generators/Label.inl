@@ -88,6 +88,9 @@ struct GenerateLabel {
    static_assert(Dimensions >= 2,
       "Label should be at least 2D");
 
+   /// Generated data depends on the label itself, so it can't be shared      
+   static constexpr bool PerDescriptor = true;
+
    ///  3     2                                                               
    ///   +---+         Each glyph is indexed in this way                      
    ///   |  /|                                                                
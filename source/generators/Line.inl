@@ -75,6 +75,13 @@ GENERATE() Positions(Mesh* model) {
       TMany<E> data;
       data << E {Axes::Origin<ScalarType>, Axes::Forward<ScalarType>};
       model->Commit<Traits::Place>(Abandon(data));
+
+      // The bounds of a single segment are the box of its two ends     
+      const Vec3f from {Axes::Origin<ScalarType>};
+      const Vec3f to {Axes::Forward<ScalarType>};
+      TMany<MeshBounds> bounds;
+      bounds << MeshBounds::FromBox(from.Min(to), from.Max(to), 0);
+      model->Commit<Traits::Bounds>(Abandon(bounds));
    }
    else static_assert(false, "Unsupported topology for line positions");
 }
@@ -13,6 +13,186 @@
 #include <Langulus/Math/Primitives/Line.hpp>
 #include <Langulus/Math/Mapping.hpp>
 #include <Langulus/Math/Color.hpp>
+#include <cstring>
+
+
+///                                                                           
+///   Geosphere subdivision helpers                                           
+///                                                                           
+/// A geosphere is an icosahedron, with every triangle split into four at     
+/// each tesselation level. New vertices are always appended, so vertices of  
+/// a level are a prefix of the vertices of the next level                    
+///                                                                           
+namespace Geosphere {
+
+   /// Closed-form vertex count of an icosahedron subdivided 'level' times    
+   constexpr Count VertexCount(Count level) {
+      return 10 * (Count {1} << (level * 2)) + 2;
+   }
+
+   /// Closed-form triangle count of an icosahedron subdivided 'level' times  
+   constexpr Count TriangleCount(Count level) {
+      return 20 * (Count {1} << (level * 2));
+   }
+
+   /// Levels up to and including this one are subdivided at compile time     
+   constexpr Count PrecomputedLevel = 4;
+
+   /// Where the indices of a level begin in Table::mIndices                  
+   constexpr Count IndexOffset(Count level) {
+      return 20 * ((Count {1} << (level * 2)) - 1);
+   }
+
+   /// Key of an edge, regardless of its direction                            
+   constexpr uint64_t EdgeKey(uint32_t a, uint32_t b) {
+      return a < b
+         ? (uint64_t {a} << 32) | b
+         : (uint64_t {b} << 32) | a;
+   }
+
+   /// Initial slot of an edge key in an open-addressing table                
+   constexpr uint64_t EdgeSlot(uint64_t key, uint64_t mask) {
+      return (key * 0x9E3779B97F4A7C15ull >> 32) & mask;
+   }
+
+   constexpr uint64_t Empty = ~uint64_t {0};
+
+   /// Compile-time tables for all levels up to PrecomputedLevel. Only the    
+   /// deepest level's vertices are kept, because all the others are a        
+   /// prefix of them. Indices of each level are kept one after another       
+   template<class P>
+   struct Table {
+      P mVertices[VertexCount(PrecomputedLevel)];
+      uint32_t mIndices[IndexOffset(PrecomputedLevel + 1)];
+   };
+
+   template<class C>
+   consteval auto Precompute();
+
+   /// The precomputed tables for a set of icosahedron constants              
+   template<class C>
+   constexpr auto Precomputed = Precompute<C>();
+
+   ///                                                                        
+   ///   Cache of edge midpoints, used while subdividing at runtime, so that  
+   /// vertices shared by neighbouring triangles are emitted only once. It is 
+   /// an open-addressing hash table with linear probing, keyed by the two    
+   /// endpoints of an edge. It is sized from the edge count, so it never     
+   /// grows, and is kept at most half full                                   
+   ///                                                                        
+   struct Edges {
+      TMany<uint64_t> mKeys;
+      TMany<uint32_t> mValues;
+      uint64_t mMask;
+
+      /// Create the cache                                                    
+      ///   @param edges - number of unique edges that will be inserted       
+      Edges(Count edges) {
+         Count capacity = 16;
+         while (capacity < edges * 2)
+            capacity <<= 1;
+         mMask = capacity - 1;
+
+         mKeys.Reserve<true>(capacity);
+         mValues.Reserve<true>(capacity);
+         for (auto& key : mKeys)
+            key = Empty;
+      }
+
+      /// Get the midpoint of an edge, creating it the first time it is seen  
+      ///   @param a, b - the edge endpoints, in any order                    
+      ///   @param make - creates the midpoint vertex, returning its index    
+      ///   @return the index of the midpoint vertex                          
+      template<class F>
+      uint32_t Get(uint32_t a, uint32_t b, F&& make) {
+         const auto key = EdgeKey(a, b);
+         auto slot = EdgeSlot(key, mMask);
+         while (mKeys[slot] != Empty) {
+            if (mKeys[slot] == key)
+               return mValues[slot];
+            slot = (slot + 1) & mMask;
+         }
+
+         mKeys[slot] = key;
+         return mValues[slot] = make();
+      }
+   };
+
+} // namespace Geosphere
+
+/// Subdivide an icosahedron at compile time, up to PrecomputedLevel. This    
+/// follows the same vertex and triangle order as the runtime subdivision,    
+/// which continues from these tables for the deeper levels                   
+///   @tparam C - the icosahedron constants, with a radius of one half        
+///   @return the tables                                                      
+template<class C>
+consteval auto Geosphere::Precompute() {
+   using P = ::std::remove_cvref_t<decltype(C::Vertices[0])>;
+   using S = TypeOf<P>;
+
+   // Large enough for the edges of the level before the last one       
+   constexpr Count Capacity = 4096;
+   static_assert(Capacity >= TriangleCount(PrecomputedLevel - 1) * 3,
+      "Edge table would be more than half full");
+
+   Table<P> table {};
+   uint64_t keys[Capacity] {};
+   uint32_t values[Capacity] {};
+
+   uint32_t vertexCount = 0;
+   for (auto& v : C::Vertices)
+      table.mVertices[vertexCount++] = v;
+
+   Count indexCount = 0;
+   for (auto& t : C::Indices) {
+      for (auto i : t)
+         table.mIndices[indexCount++] = i;
+   }
+
+   for (Count level = 0; level < PrecomputedLevel; ++level) {
+      for (auto& key : keys)
+         key = Empty;
+
+      const auto midpoint = [&](uint32_t a, uint32_t b) -> uint32_t {
+         const auto key = EdgeKey(a, b);
+         auto slot = EdgeSlot(key, Capacity - 1);
+         while (keys[slot] != Empty) {
+            if (keys[slot] == key)
+               return values[slot];
+            slot = (slot + 1) & (Capacity - 1);
+         }
+
+         // Push the midpoint out to the surface of the sphere          
+         const auto& va = table.mVertices[a];
+         const auto& vb = table.mVertices[b];
+         const S x = va[0] + vb[0];
+         const S y = va[1] + vb[1];
+         const S z = va[2] + vb[2];
+         const S scale = S {1} / (S {2} * Sqrt(x * x + y * y + z * z));
+         table.mVertices[vertexCount] = P {x * scale, y * scale, z * scale};
+
+         keys[slot] = key;
+         values[slot] = vertexCount;
+         return vertexCount++;
+      };
+
+      const auto from = table.mIndices + IndexOffset(level);
+      auto to = table.mIndices + IndexOffset(level + 1);
+      for (Count i = 0; i < TriangleCount(level) * 3; i += 3) {
+         const auto t = from + i;
+         const auto ab = midpoint(t[0], t[1]);
+         const auto bc = midpoint(t[1], t[2]);
+         const auto ca = midpoint(t[2], t[0]);
+
+         *to++ = t[0]; *to++ = ab;   *to++ = ca;
+         *to++ = ab;   *to++ = t[1]; *to++ = bc;
+         *to++ = ca;   *to++ = bc;   *to++ = t[2];
+         *to++ = ab;   *to++ = bc;   *to++ = ca;
+      }
+   }
+
+   return table;
+}
 
 
 ///                                                                           
@@ -29,6 +209,10 @@ struct GenerateSphere {
    static constexpr ScalarType Half = ScalarType {1} / ScalarType {2};
 
    static_assert(Dimensions >= 2, "Sphere should be at least 2D");
+
+   /// Positions and indices come out of the same subdivision, so they are    
+   /// committed together, and everything else is made out of the positions   
+   using FromPositions = TypeList<Traits::Index, Traits::Aim, Traits::Sampler>;
    
    /// Properties for a 3D sphere                                             
    struct Constants3D {
@@ -73,6 +257,13 @@ struct GenerateSphere {
 
    using D = Conditional<Dimensions == 2, Constants2D, Constants3D>;
 
+   /// Each tesselation level splits every triangle into four                 
+   static constexpr Count MaxTesselation = 10;
+
+   static auto GetTesselation(const Mesh*) -> Count;
+   static void GetGeosphere(Count, TMany<PointType>&, TMany<uint32_t>&);
+   static void Subdivide(Count, TMany<PointType>&, TMany<uint32_t>&, Count startLevel = Geosphere::PrecomputedLevel);
+
    static bool Default(Construct&);
    static auto Detail(const Mesh*, const LOD&) -> Construct;
 
@@ -199,13 +390,167 @@ auto GenerateSphere<T, TOPOLOGY>::Detail(const Mesh* model, const LOD& lod) -> C
    return Construct::From<A::Mesh>(md);
 }
 
-/// Generate positions for a sphere/circle                                    
+/// Get the tesselation level of a sphere                                     
+///   @param model - the sphere                                               
+///   @return the number of times the icosahedron is subdivided               
+template<CT::Sphere T, CT::Topology TOPOLOGY>
+auto GenerateSphere<T, TOPOLOGY>::GetTesselation(const Mesh* model) -> Count {
+   unsigned tesselation = 0;
+   model->GetDescriptor().ExtractTrait<Traits::Tesselation>(tesselation);
+   LANGULUS_ASSERT(tesselation <= MaxTesselation, Mesh,
+      "Sphere tesselation too high: ", tesselation);
+   return tesselation;
+}
+
+/// Get the vertices and indices of a geosphere. The common low levels are    
+/// copied straight out of the compile-time tables, the deeper ones are       
+/// subdivided                                                                
+///   @param level - number of subdivisions                                   
+///   @param vertices - [out] the vertices                                    
+///   @param indices - [out] three indices per triangle                       
+template<CT::Sphere T, CT::Topology TOPOLOGY>
+void GenerateSphere<T, TOPOLOGY>::GetGeosphere(
+   Count level, TMany<PointType>& vertices, TMany<uint32_t>& indices
+) {
+   if (level > Geosphere::PrecomputedLevel) {
+      Subdivide(level, vertices, indices);
+      return;
+   }
+
+   const auto& table = Geosphere::Precomputed<D>;
+   vertices.template Reserve<true>(Geosphere::VertexCount(level));
+   ::std::memcpy(static_cast<void*>(vertices.GetRaw()), table.mVertices,
+      vertices.GetCount() * sizeof(PointType));
+
+   indices.template Reserve<true>(Geosphere::TriangleCount(level) * 3);
+   ::std::memcpy(indices.GetRaw(), table.mIndices + Geosphere::IndexOffset(level),
+      indices.GetCount() * sizeof(uint32_t));
+}
+
+/// Subdivide the icosahedron into a geosphere at runtime, continuing from    
+/// the deepest precomputed level. Each level splits every triangle into      
+/// four, pushing the new vertices out to the sphere surface. Midpoints are   
+/// cached per edge, so that every vertex is emitted exactly once, and both   
+/// arrays are allocated only once, from the closed-form vertex and triangle  
+/// counts                                                                    
+///   @param level - number of subdivisions                                   
+///   @param vertices - [out] the vertices                                    
+///   @param indices - [out] three indices per triangle                       
+///   @param startLevel - the precomputed level to continue from. Lower      
+///      levels are subdivided at runtime too, which is how the tables are    
+///      tested                                                               
+template<CT::Sphere T, CT::Topology TOPOLOGY>
+void GenerateSphere<T, TOPOLOGY>::Subdivide(
+   Count level, TMany<PointType>& vertices, TMany<uint32_t>& indices,
+   Count startLevel
+) {
+   static_assert(Dimensions >= 3, "Only geospheres can be subdivided");
+   const auto indexCount = Geosphere::TriangleCount(level) * 3;
+   vertices.Reserve(Geosphere::VertexCount(level));
+   indices.Reserve(indexCount);
+
+   const auto start = Min(Min(level, startLevel), Geosphere::PrecomputedLevel);
+   const auto& table = Geosphere::Precomputed<D>;
+   for (Offset i = 0; i < Geosphere::VertexCount(start); ++i)
+      vertices << table.mVertices[i];
+   for (Offset i = 0; i < Geosphere::TriangleCount(start) * 3; ++i)
+      indices << table.mIndices[Geosphere::IndexOffset(start) + i];
+
+   if (start == level)
+      return;
+
+   // Subdivide back and forth between two index buffers                
+   TMany<uint32_t> next;
+   next.Reserve(indexCount);
+   auto from = &indices;
+   auto to = &next;
+
+   for (Count l = start; l < level; ++l) {
+      // Each edge is shared by exactly two triangles                   
+      Geosphere::Edges edges {Geosphere::TriangleCount(l) * 3 / 2};
+      const auto midpoint = [&](uint32_t a, uint32_t b) {
+         return edges.Get(a, b, [&] {
+            const auto index = static_cast<uint32_t>(vertices.GetCount());
+            const PointType m = (vertices[a] + vertices[b]).Normalize() * Half;
+            vertices << m;
+            return index;
+         });
+      };
+
+      to->Clear();
+      auto t = from->GetRaw();
+      const auto tEnd = from->GetRawEnd();
+      for (; t != tEnd; t += 3) {
+         const auto ab = midpoint(t[0], t[1]);
+         const auto bc = midpoint(t[1], t[2]);
+         const auto ca = midpoint(t[2], t[0]);
+
+         auto& out = *to;
+         out << t[0] << ab << ca;
+         out << ab << t[1] << bc;
+         out << ca << bc << t[2];
+         out << ab << bc << ca;
+      }
+
+      ::std::swap(from, to);
+   }
+
+   if (from != &indices)
+      indices = Move(next);
+
+   LANGULUS_ASSUME(DevAssumes, vertices.GetCount() == Geosphere::VertexCount(level),
+      "Vertex count mismatch");
+   LANGULUS_ASSUME(DevAssumes, indices.GetCount() == indexCount,
+      "Index count mismatch");
+}
+
+/// Generate positions for a sphere/circle. Triangle indices come out of the  
+/// same subdivision, so they're committed here too, and deep tesselation     
+/// levels are subdivided only once                                           
 ///   @param model - the model to fill                                        
 GENERATE() Positions(Mesh* model) {
    // A geosphere/circle made of triangles/lines/points                 
    // This geometry is always indexes, so all positions go              
-   TMany<PointType> data = D::Vertices;
-   model->Commit<Traits::Place>(Abandon(data));
+   TMany<PointType> vertices;
+   TMany<uint32_t> indices;
+   GetGeosphere(GetTesselation(model), vertices, indices);
+
+   TMany<MeshBounds> bounds;
+   if constexpr (Dimensions >= 3) {
+      // All vertices are on a sphere with a radius of one half, so     
+      // the box and sphere are known in closed form                    
+      MeshBounds sphere;
+      sphere.mMin = {-.5f, -.5f, -.5f};
+      sphere.mMax = { .5f,  .5f,  .5f};
+      sphere.mCenter = {0, 0, 0};
+      sphere.mRadius = .5f;
+
+      if constexpr (CT::Triangle<TOPOLOGY>) {
+         // The area is the one of the triangles, like for any other    
+         // mesh, which is a bit less than the one of the ideal sphere  
+         double area = 0;
+         for (Offset i = 0; i + 3 <= indices.GetCount(); i += 3) {
+            const auto& a = vertices[indices[i]];
+            const auto ab = vertices[indices[i + 1]] - a;
+            const auto ac = vertices[indices[i + 2]] - a;
+            const double n[3] {
+               ab[1] * ac[2] - ab[2] * ac[1],
+               ab[2] * ac[0] - ab[0] * ac[2],
+               ab[0] * ac[1] - ab[1] * ac[0]
+            };
+            area += Sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+         }
+         sphere.mArea = static_cast<float>(area / 2);
+      }
+
+      bounds << sphere;
+   }
+
+   model->template Commit<Traits::Place>(Abandon(vertices));
+   if constexpr (CT::Triangle<TOPOLOGY>)
+      model->template Commit<Traits::Index>(Abandon(indices));
+   if (bounds)
+      model->template Commit<Traits::Bounds>(Abandon(bounds));
 }
 
 /// Generate normals for a sphere/circle                                      
@@ -213,16 +558,19 @@ GENERATE() Positions(Mesh* model) {
 GENERATE() Normals(Mesh* model) {
    if constexpr (CT::Triangle<TOPOLOGY>) {
       TMany<Normal> data;
-      data.Reserve(D::VertexCount);
 
       if constexpr (Dimensions >= 3) {
          // Normals for a 3D sphere - shared for each point             
-         for (auto& v : D::Vertices)
-            data << Normal {v};
+         model->Generate(MetaOf<Traits::Place>());
+         const auto positions = model->template GetData<Traits::Place>();
+         data.Reserve(positions->GetCount());
+         for (Offset i = 0; i < positions->GetCount(); ++i)
+            data << Normal {positions->template AsCast<PointType>(i)};
       }
       else if constexpr (Dimensions == 2) {
          // Normals for a 2D circle, always facing the user (-Z)        
          constexpr Normal b {Axes::Backward<ScalarType>};
+         data.Reserve(D::VertexCount);
          for (auto& v : D::Vertices)
             data << b;
       }
@@ -238,13 +586,14 @@ GENERATE() Normals(Mesh* model) {
 GENERATE() Indices(Mesh* model) {
    TMany<uint32_t> data;
    if constexpr (CT::Triangle<TOPOLOGY>) {
-      // A geosphere/circle made out of triangles                       
-      data.Reserve(D::IndexCount);
-      for (int i = 0; i < D::TriangleCount; ++i) {
-         data << D::Indices[i][0];
-         data << D::Indices[i][1];
-         data << D::Indices[i][2];
-      }
+      // A geosphere/circle made out of triangles, that are committed   
+      // along with the positions                                       
+      model->Generate(MetaOf<Traits::Place>());
+      if (model->template GetData<Traits::Index>())
+         return;
+
+      TMany<PointType> vertices;
+      GetGeosphere(GetTesselation(model), vertices, data);
    }
    else if constexpr (CT::Line<TOPOLOGY>) {
       // A geosphere/circle made out of lines                           
@@ -262,10 +611,13 @@ GENERATE() Indices(Mesh* model) {
 /// Generate texture coordinates for a sphere/circle                          
 ///   @param model - the geometry instance to save data in                    
 GENERATE() TextureCoords(Mesh* model) {
+   model->Generate(MetaOf<Traits::Place>());
+   const auto positions = model->template GetData<Traits::Place>();
+
    TMany<PointType> data;
-   data.Reserve(D::VertexCount);
-   for (auto& v : D::Vertices)
-      data << (v + Half);
+   data.Reserve(positions->GetCount());
+   for (Offset i = 0; i < positions->GetCount(); ++i)
+      data << (positions->template AsCast<PointType>(i) + Half);
    model->template Commit<Traits::Sampler>(Abandon(data));
 }
 
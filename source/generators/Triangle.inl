@@ -107,13 +107,22 @@ auto GenerateTriangle<T, TOPOLOGY>::Detail(const Mesh* model, const LOD&) -> Con
 GENERATE() Positions(Mesh* model) {
    TMany<PointType> data = TriangleVertices;
    model->Commit<Traits::Place>(Abandon(data));
+
+   // The triangle spans a unit square, with its base on one side, and  
+   // its apex in the middle of the other                               
+   constexpr float h = 0.5f;
+   constexpr float area = CT::Triangle<TOPOLOGY> ? h : 0;
+
+   TMany<MeshBounds> bounds;
+   bounds << MeshBounds::FromBox({-h, -h, 0}, {h, h, 0}, area);
+   model->Commit<Traits::Bounds>(Abandon(bounds));
 }
 
 /// Generate indices for triangle                                             
 ///   @param model - the geometry instance to save data in                    
 GENERATE() Indices(Mesh* model) {
    TMany<uint32_t> data {0, 1, 2};
-   model->Commit<Traits::Place>(Abandon(data));
+   model->Commit<Traits::Index>(Abandon(data));
 }
 
 /// Generate normals for triangle                                             
@@ -134,7 +143,7 @@ GENERATE() TextureCoords(Mesh* model) {
    data.Reserve(VertexCount);
    for (auto& v : TriangleVertices)
       data << v;
-   model->template Commit<Traits::Aim>(Abandon(data));
+   model->template Commit<Traits::Sampler>(Abandon(data));
 }
 
 GENERATE() Materials(Mesh*) {
@@ -101,6 +101,14 @@ struct GenerateZode {
 
    static_assert(Dimensions >= 3, "Zode should be at least 3D");
 
+   /// Generated data depends on the zode's place and size, so it can't be    
+   /// shared with other zodes                                                
+   static constexpr bool PerDescriptor = true;
+
+   /// Normals and texture coordinates are made out of the positions, so      
+   /// they're generated after them                                           
+   using FromPositions = TypeList<Traits::Aim, Traits::Sampler>;
+
    static bool Default(Construct&);
    static auto Detail(const Mesh*, const LOD&) -> Construct;
 
@@ -216,12 +224,25 @@ GENERATE() Positions(Mesh* model) {
       orient *= rotator;
    }
 
+   // The zode is a patch of a sphere, so its bounds are found from its 
+   // points, while they're at hand. Strips have no area, like with any 
+   // other mesh                                                        
+   TMany<Vec3f> bounded;
+   bounded.Reserve(data.GetCount());
+   for (const auto& point : data)
+      bounded << Vec3f {point};
+
+   TMany<MeshBounds> bounds;
+   bounds << MeshBounds::FromPositions(bounded.GetRaw(), bounded.GetCount());
+
    model->Commit<Traits::Place>(Abandon(data));
+   model->Commit<Traits::Bounds>(Abandon(bounds));
 }
 
 /// Generate normals for a zode                                               
 ///   @param model - the geometry instance to save data in                    
 GENERATE() Normals(Mesh* model) {
+   model->Generate(MetaOf<Traits::Place>());
    const auto positions = model->GetData<Traits::Place>();
 
    TMany<Normal> data;
@@ -318,6 +339,7 @@ GENERATE() Indices(Mesh* model) {
 /// Generate texture coordinates for a zode                                   
 ///   @param model - the geometry instance to save data in                    
 GENERATE() TextureCoords(Mesh* model) {
+   model->Generate(MetaOf<Traits::Place>());
    const auto positions = model->GetData<Traits::Place>();
 
    TMany<Sampler3> data;
@@ -0,0 +1,138 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include <Langulus/Mesh.hpp>
+#include <Langulus/Testing.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+/// The folder, where the file system module looks for meshes                 
+static const std::filesystem::path Folder =
+   LANGULUS_MOD_ASSETS_GEOMETRY_TEST_MESHES "/cache";
+
+/// Streams of a loaded mesh, copied out, so that they outlive the module     
+struct Streams {
+   std::vector<float> positions;
+   std::vector<float> normals;
+   std::vector<float> texcoords;
+   std::vector<uint32_t> indices;
+};
+
+/// Write a quad, with an optional triangle attached to it                    
+///   @param z - depth of the first vertex                                    
+///   @param triangle - whether to add the triangle                           
+///   @param comment - length of a comment to put before the quad             
+static void Write(char z, bool triangle, size_t comment = 0) {
+   std::ofstream file {Folder / "quad.obj", std::ios::binary | std::ios::trunc};
+   if (comment)
+      file << '#' << std::string(comment, ' ') << '\n';
+   file << "v 0 0 " << z << "\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        << "vn 0 0 1\n"
+        << "f 1/1/1 2/2/1 3/3/1 4/4/1\n";
+   if (triangle)
+      file << "v 2 1 0\nf 2/2/1 5/3/1 3/3/1\n";
+}
+
+/// Load the quad in a root of its own, and copy its streams out              
+///   @return the streams                                                     
+static Streams Load() {
+   auto root = Thing::Root<false>(
+      "FileSystem",
+      "AssetsGeometry"
+   );
+
+   auto producedMesh = root.CreateUnit<A::Mesh>("cache/quad.obj");
+   REQUIRE(producedMesh.GetCount() == 1);
+   auto& mesh = producedMesh.As<A::Mesh>();
+
+   Streams result;
+   const auto copy = [](const Many* data, std::vector<float>& to, int size) {
+      REQUIRE(data);
+      for (Offset i = 0; i < data->GetCount(); ++i) {
+         if (size == 3) {
+            const auto v = data->AsCast<Vec3f>(i);
+            to.insert(to.end(), {v[0], v[1], v[2]});
+         }
+         else {
+            const auto v = data->AsCast<Vec2f>(i);
+            to.insert(to.end(), {v[0], v[1]});
+         }
+      }
+   };
+
+   copy(mesh.GetData<Traits::Place>(), result.positions, 3);
+   copy(mesh.GetData<Traits::Aim>(), result.normals, 3);
+   copy(mesh.GetData<Traits::Sampler>(), result.texcoords, 2);
+
+   const auto indices = mesh.GetData<Traits::Index>();
+   REQUIRE(indices);
+   for (Offset i = 0; i < indices->GetCount(); ++i)
+      result.indices.push_back(indices->AsCast<uint32_t>(i));
+   return result;
+}
+
+SCENARIO("Caching loaded meshes", "[mesh][cache]") {
+   GIVEN("An OBJ file without a cache") {
+      const auto cache = Folder / "quad.obj.cache";
+      std::filesystem::create_directories(Folder);
+      std::filesystem::remove(cache);
+      Write('0', false);
+
+      WHEN("The file is loaded") {
+         const auto loaded = Load();
+
+         THEN("A cache is written next to it") {
+            REQUIRE(std::filesystem::exists(cache));
+            REQUIRE(loaded.positions.size() >= 4 * 3);
+            REQUIRE(loaded.indices.size() == 2 * 3);
+         }
+
+         THEN("Loading it again reads the same streams from the cache") {
+            const auto written = std::filesystem::last_write_time(cache);
+            const auto cached = Load();
+
+            // The cache wasn't written again, so it was read           
+            REQUIRE(std::filesystem::last_write_time(cache) == written);
+            REQUIRE(cached.positions == loaded.positions);
+            REQUIRE(cached.normals == loaded.normals);
+            REQUIRE(cached.texcoords == loaded.texcoords);
+            REQUIRE(cached.indices == loaded.indices);
+         }
+
+         THEN("A source of a different size invalidates the cache") {
+            Write('0', true);
+            const auto changed = Load();
+
+            REQUIRE(changed.positions.size() == loaded.positions.size() + 3);
+            REQUIRE(changed.indices.size() == loaded.indices.size() + 3);
+         }
+
+         THEN("A source of the same size invalidates the cache") {
+            Write('5', false);
+            const auto changed = Load();
+
+            REQUIRE(changed.positions.size() == loaded.positions.size());
+            REQUIRE(changed.positions != loaded.positions);
+         }
+
+         THEN("An edit of the same size far into the source invalidates the cache") {
+            // The quad is well past the first 64 KiB of the file       
+            Write('0', false, 70000);
+            const auto padded = Load();
+            Write('5', false, 70000);
+            const auto changed = Load();
+
+            REQUIRE(changed.positions.size() == padded.positions.size());
+            REQUIRE(changed.positions != padded.positions);
+         }
+      }
+   }
+}
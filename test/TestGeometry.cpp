@@ -135,3 +135,43 @@ SCENARIO("Loading OBJ file", "[mesh]") {
       }
    }
 }
+
+SCENARIO("Generating all data lists at once", "[mesh]") {
+   static Allocator::State memoryState;
+
+   for (int repeat = 0; repeat != 10; ++repeat) {
+      GIVEN(std::string("Init and shutdown cycle #") + std::to_string(repeat)) {
+         // Create root entity                                          
+         auto root = Thing::Root<false>(
+            "FileSystem",
+            "AssetsGeometry"
+         );
+
+         WHEN("All data of an indexed primitive is generated") {
+            auto producedMesh = root.CreateUnit<A::Mesh>(Math::Box3 {});
+            auto& mesh = producedMesh.As<A::Mesh>();
+
+            // Bounds and meshlets are generated in waves after the     
+            // streams they're made of                                  
+            REQUIRE(mesh.Generate(TMeta {}));
+            REQUIRE(mesh.GetData<Traits::Place>());
+            REQUIRE(mesh.GetData<Traits::Index>());
+            REQUIRE(mesh.GetData<Traits::Aim>());
+         }
+
+         WHEN("All data of a primitive without indices is generated") {
+            auto producedMesh = root.CreateUnit<A::Mesh>(Math::TLine<Math::Vec3> {});
+            auto& mesh = producedMesh.As<A::Mesh>();
+
+            // Generators that look for indices find none, instead of   
+            // waiting for them                                         
+            REQUIRE(mesh.Generate(TMeta {}));
+            REQUIRE(mesh.GetData<Traits::Place>());
+            REQUIRE_FALSE(mesh.GetData<Traits::Index>());
+         }
+
+         // Check for memory leaks after each cycle                     
+         REQUIRE(memoryState.Assert());
+      }
+   }
+}
@@ -0,0 +1,100 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "../source/Scanner.hpp"
+#include <Langulus/Testing.hpp>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+
+/// Compare a set of kernels against the scalar reference, at every offset    
+///   @param text - the text to scan, must end with a newline, followed by    
+///      Scanner::Padding bytes                                               
+///   @param k - the kernels to test                                          
+///   @return the number of mismatches                                        
+static int Differ(const std::string& text, const Scanner::Kernels& k) {
+   int mismatches = 0;
+   const auto end = text.data() + text.size() - Scanner::Padding;
+
+   for (auto p = text.data(); p != end; ++p) {
+      mismatches += Scanner::Scalar::SkipWhitespace(p) != k.SkipWhitespace(p);
+      mismatches += Scanner::Scalar::SkipLine(p) != k.SkipLine(p);
+      mismatches += Scanner::Scalar::SkipDigits(p) != k.SkipDigits(p);
+
+      float f1, f2;
+      const auto pf1 = Scanner::Scalar::ParseFloat(p, &f1);
+      const auto pf2 = Scanner::ParseFloat(k, p, &f2);
+      mismatches += pf1 != pf2 or ::std::memcmp(&f1, &f2, sizeof(float)) != 0;
+
+      int i1, i2;
+      const auto pi1 = Scanner::Scalar::ParseInt(p, &i1);
+      const auto pi2 = Scanner::ParseInt(k, p, &i2);
+      mismatches += pi1 != pi2 or i1 != i2;
+   }
+
+   return mismatches;
+}
+
+SCENARIO("Vectorized OBJ tokenizers", "[scanner]") {
+   GIVEN("The contents of maxwell.obj") {
+      std::ifstream file {LANGULUS_MOD_ASSETS_GEOMETRY_TEST_DATA "/maxwell.obj"};
+      std::stringstream contents;
+      contents << file.rdbuf();
+      std::string text = contents.str();
+      REQUIRE(not text.empty());
+      if (text.back() != '\n')
+         text += '\n';
+
+      // Add some numbers that hit the edge cases                       
+      text += "v 12345678901234567890.1234567890123456789 -0.0 +.5\n";
+      text += "v 123456789012345.123456789012345 1e19 1E20 1e-19\n";
+      text += "f -2147483647/12/-3 1234567890//7 2147483647\n";
+
+      // Vectorized kernels might read past the final newline           
+      text.append(Scanner::Padding, '\0');
+
+      WHEN("Scanned with the active kernels") {
+         REQUIRE(Differ(text, Scanner::Active()) == 0);
+      }
+
+   #if LANGULUS_SCANNER_X86
+      WHEN("Scanned with the SSE2 kernels") {
+         REQUIRE(Differ(text, Scanner::SSE2::Table) == 0);
+      }
+
+      WHEN("Scanned with the AVX2 kernels") {
+         if (Scanner::SupportsAVX2())
+            REQUIRE(Differ(text, Scanner::AVX2::Table) == 0);
+      }
+   #endif
+   }
+
+   GIVEN("Integers that don't fit in an int") {
+      std::string text = "-2147483648 2147483648 99999999999\n";
+      text.append(Scanner::Padding, '\0');
+
+      WHEN("Parsed with the scalar and the active kernels") {
+         int scalar[3], active[3];
+         const char* p1 = text.data();
+         const char* p2 = text.data();
+         for (int i = 0; i < 3; ++i) {
+            p1 = Scanner::Scalar::ParseInt(Scanner::Scalar::SkipWhitespace(p1), &scalar[i]);
+            p2 = Scanner::ParseInt(Scanner::Active(), Scanner::Active().SkipWhitespace(p2), &active[i]);
+         }
+
+         // They wrap around modulo 2^32                                
+         REQUIRE(p1 == p2);
+         REQUIRE(scalar[0] == INT_MIN);
+         REQUIRE(scalar[1] == INT_MIN);
+         REQUIRE(scalar[2] == 1215752191);
+         for (int i = 0; i < 3; ++i)
+            REQUIRE(active[i] == scalar[i]);
+      }
+   }
+}
@@ -0,0 +1,290 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "../../source/Bvh.hpp"
+#include <Langulus/Testing.hpp>
+#include <cfloat>
+#include <cmath>
+#include <string>
+#include <vector>
+
+
+/// A linear congruential generator, so that failures are reproducible        
+struct Random {
+   uint32_t mState = 12345;
+
+   /// Get a number in a range                                                
+   ///   @param min - the smallest number                                     
+   ///   @param max - the largest number                                      
+   ///   @return the number                                                   
+   float operator () (float min, float max) {
+      mState = mState * 1664525u + 1013904223u;
+      return min + (max - min) * static_cast<float>(mState >> 8) / 16777216.f;
+   }
+};
+
+/// Triangles and their hierarchy                                             
+struct Scene {
+   TMany<Vec3f>    positions;
+   TMany<uint32_t> indices;
+   TMany<BvhNode>  nodes;
+   TMany<uint32_t> triangles;
+   TMany<Vec3f>    vertices;
+
+   /// A grid of quads in the XY plane, that axis-parallel rays hit head on,  
+   /// and random triangles on both sides of it                               
+   Scene() {
+      for (int y = 0; y <= 8; ++y) {
+         for (int x = 0; x <= 8; ++x)
+            positions << Vec3f {static_cast<float>(x), static_cast<float>(y), 0.f};
+      }
+
+      for (uint32_t y = 0; y < 8; ++y) {
+         for (uint32_t x = 0; x < 8; ++x) {
+            const auto a = y * 9 + x;
+            indices << a << a + 1 << a + 10;
+            indices << a << a + 10 << a + 9;
+         }
+      }
+
+      Random random;
+      for (int t = 0; t < 300; ++t) {
+         const Vec3f center {random(0, 8), random(0, 8), random(-4, 4)};
+         for (int v = 0; v < 3; ++v) {
+            indices << static_cast<uint32_t>(positions.GetCount());
+            positions << Vec3f {
+               center[0] + random(-.5f, .5f),
+               center[1] + random(-.5f, .5f),
+               center[2] + random(-.5f, .5f)
+            };
+         }
+      }
+
+      Workers workers;
+      Bvh::Build(positions, indices, workers, nodes, triangles, vertices);
+   }
+
+   /// Find the closest hit through the hierarchy                             
+   bool Intersect(const Vec3f& origin, const Vec3f& direction, float maxDistance, RayHit& hit) const {
+      return Bvh::Intersect(nodes.GetRaw(), triangles.GetRaw(), vertices.GetRaw(),
+         origin, direction, maxDistance, hit);
+   }
+
+   /// Find the closest hit by testing every triangle, Moller-Trumbore style, 
+   /// in double precision                                                    
+   bool BruteForce(const Vec3f& origin, const Vec3f& direction, float maxDistance, RayHit& hit) const {
+      const auto sub = [](const Vec3f& a, const Vec3f& b, double (&r)[3]) {
+         for (int c = 0; c < 3; ++c)
+            r[c] = static_cast<double>(a[c]) - b[c];
+      };
+      const auto cross = [](const double (&a)[3], const double (&b)[3], double (&r)[3]) {
+         r[0] = a[1] * b[2] - a[2] * b[1];
+         r[1] = a[2] * b[0] - a[0] * b[2];
+         r[2] = a[0] * b[1] - a[1] * b[0];
+      };
+      const auto dot = [](const double (&a)[3], const double (&b)[3]) {
+         return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+      };
+
+      const double d[3] {direction[0], direction[1], direction[2]};
+      double best = maxDistance;
+      bool found = false;
+
+      for (uint32_t t = 0; t < indices.GetCount() / 3; ++t) {
+         const auto& v0 = positions[indices[t * 3 + 0]];
+         const auto& v1 = positions[indices[t * 3 + 1]];
+         const auto& v2 = positions[indices[t * 3 + 2]];
+
+         double e1[3], e2[3], p[3], s[3], q[3];
+         sub(v1, v0, e1);
+         sub(v2, v0, e2);
+         cross(d, e2, p);
+         const auto det = dot(e1, p);
+         if (det == 0)
+            continue;
+
+         sub(origin, v0, s);
+         const auto u = dot(s, p) / det;
+         cross(s, e1, q);
+         const auto v = dot(d, q) / det;
+         const auto distance = dot(e2, q) / det;
+         if (u < 0 or v < 0 or u + v > 1 or distance < 0 or distance >= best)
+            continue;
+
+         best = distance;
+         hit = {
+            static_cast<float>(distance), t,
+            static_cast<float>(u), static_cast<float>(v)
+         };
+         found = true;
+      }
+
+      return found;
+   }
+
+   /// Check that a ray hits the same triangle through the hierarchy, as it   
+   /// does when testing every triangle                                       
+   void Compare(const Vec3f& origin, const Vec3f& direction, float maxDistance = FLT_MAX) const {
+      RayHit hit, expected;
+      const auto found = Intersect(origin, direction, maxDistance, hit);
+      REQUIRE(found == BruteForce(origin, direction, maxDistance, expected));
+      if (not found)
+         return;
+
+      REQUIRE(hit.mTriangle == expected.mTriangle);
+      REQUIRE(std::abs(hit.mDistance - expected.mDistance) < 1e-4f);
+      REQUIRE(std::abs(hit.mU - expected.mU) < 1e-4f);
+      REQUIRE(std::abs(hit.mV - expected.mV) < 1e-4f);
+   }
+
+   /// Check that a batch of rays hits the same triangles, as each of the     
+   /// rays does on its own                                                   
+   ///   @param rays - the rays                                               
+   void Compare(const RayBatch& rays) const {
+      std::vector<RayHit> hits(rays.mCount);
+      const auto found = Bvh::Intersect(nodes.GetRaw(), triangles.GetRaw(),
+         vertices.GetRaw(), rays, hits.data());
+
+      Count expected = 0;
+      for (Offset i = 0; i < rays.mCount; ++i) {
+         const Vec3f origin {rays.mOrigin[0][i], rays.mOrigin[1][i], rays.mOrigin[2][i]};
+         const Vec3f direction {rays.mDirection[0][i], rays.mDirection[1][i], rays.mDirection[2][i]};
+         const auto maxDistance = rays.mMaxDistance ? rays.mMaxDistance[i] : FLT_MAX;
+
+         RayHit hit;
+         if (not Intersect(origin, direction, maxDistance, hit)) {
+            REQUIRE(hits[i].mTriangle == RayHit::Miss);
+            continue;
+         }
+
+         ++expected;
+         REQUIRE(hits[i].mTriangle == hit.mTriangle);
+         REQUIRE(std::abs(hits[i].mDistance - hit.mDistance) < 1e-5f);
+         REQUIRE(std::abs(hits[i].mU - hit.mU) < 1e-5f);
+         REQUIRE(std::abs(hits[i].mV - hit.mV) < 1e-5f);
+      }
+
+      REQUIRE(found == expected);
+   }
+};
+
+/// Rays, with a separate array for each coordinate                           
+struct Rays {
+   std::vector<float> mOrigin[3];
+   std::vector<float> mDirection[3];
+   std::vector<float> mMaxDistance;
+
+   /// Add a ray                                                              
+   void Add(const Vec3f& origin, const Vec3f& direction, float maxDistance = FLT_MAX) {
+      for (int c = 0; c < 3; ++c) {
+         mOrigin[c].push_back(origin[c]);
+         mDirection[c].push_back(direction[c]);
+      }
+      mMaxDistance.push_back(maxDistance);
+   }
+
+   /// Get the batch of the first rays                                        
+   ///   @param count - number of rays in the batch                           
+   ///   @param limited - whether rays have a maximum distance                
+   ///   @return the batch                                                    
+   RayBatch Batch(Count count, bool limited) const {
+      RayBatch batch;
+      for (int c = 0; c < 3; ++c) {
+         batch.mOrigin[c] = mOrigin[c].data();
+         batch.mDirection[c] = mDirection[c].data();
+      }
+      batch.mMaxDistance = limited ? mMaxDistance.data() : nullptr;
+      batch.mCount = count;
+      return batch;
+   }
+};
+
+
+SCENARIO("Ray queries over a bounding volume hierarchy", "[bvh]") {
+   GIVEN("A hierarchy over a grid, and random triangles around it") {
+      const Scene scene;
+      REQUIRE(scene.triangles.GetCount() == 8 * 8 * 2 + 300);
+      REQUIRE(scene.vertices.GetCount() == scene.triangles.GetCount() * 3);
+
+      WHEN("Rays are cast in random directions") {
+         Random random;
+         for (int i = 0; i < 1000; ++i) {
+            const Vec3f origin {random(-2, 10), random(-2, 10), random(-6, 6)};
+            const Vec3f direction {random(-1, 1), random(-1, 1), random(-1, 1)};
+            scene.Compare(origin, direction);
+         }
+      }
+
+      WHEN("Rays are cast along the axes") {
+         // Zero direction components have no inverse, and are traced   
+         // as if they were tiny, with either sign                      
+         for (int y = 0; y < 8; ++y) {
+            for (int x = 0; x < 8; ++x) {
+               const float fx = x + .3f;
+               const float fy = y + .6f;
+               scene.Compare(Vec3f {fx, fy, 10.f}, Vec3f {0.f, 0.f, -1.f});
+               scene.Compare(Vec3f {fx, fy, -10.f}, Vec3f {-0.f, -0.f, 1.f});
+               scene.Compare(Vec3f {fx, fy, .25f}, Vec3f {0.f, 0.f, -2.f});
+               scene.Compare(Vec3f {-5.f, fy, fx - 4}, Vec3f {1.f, 0.f, 0.f});
+               scene.Compare(Vec3f {13.f, fy, fx - 4}, Vec3f {-1.f, -0.f, 0.f});
+               scene.Compare(Vec3f {fx, -5.f, fy - 4}, Vec3f {0.f, 1.f, -0.f});
+               scene.Compare(Vec3f {fx, 13.f, fy - 4}, Vec3f {0.f, -1.f, 0.f});
+            }
+         }
+      }
+
+      WHEN("Segments are cast") {
+         Random random;
+         for (int i = 0; i < 1000; ++i) {
+            const Vec3f from {random(-2, 10), random(-2, 10), random(-6, 6)};
+            const Vec3f to {random(-2, 10), random(-2, 10), random(-6, 6)};
+            const Vec3f direction {to[0] - from[0], to[1] - from[1], to[2] - from[2]};
+            scene.Compare(from, direction, 1);
+         }
+      }
+   }
+}
+
+SCENARIO("Ray queries in batches", "[bvh]") {
+   GIVEN("A hierarchy over a grid, and random triangles around it") {
+      const Scene scene;
+
+      // Random rays and segments, and rays along the axes, some of     
+      // which miss everything                                          
+      Rays rays;
+      Random random;
+      for (int i = 0; i < 64; ++i) {
+         const Vec3f origin {random(-2, 10), random(-2, 10), random(-6, 6)};
+         const Vec3f direction {random(-1, 1), random(-1, 1), random(-1, 1)};
+         switch (i % 4) {
+         case 0:
+            rays.Add(origin, direction);
+            break;
+         case 1:
+            rays.Add(origin, direction, 1);
+            break;
+         case 2:
+            rays.Add(Vec3f {origin[0], origin[1], 10.f}, Vec3f {0.f, 0.f, -1.f}, 12);
+            break;
+         default:
+            rays.Add(Vec3f {-5.f, origin[1], origin[2]}, Vec3f {1.f, -0.f, 0.f}, random(0, 10));
+         }
+      }
+
+      // Counts that aren't a multiple of the packet width leave some   
+      // lanes of the last packet unused                                
+      for (Count count : {1, 3, 4, 5, 8, 13, 37, 64}) {
+         WHEN("A batch of " + std::to_string(count) + " rays is cast") {
+            scene.Compare(rays.Batch(count, true));
+         }
+
+         WHEN("A batch of " + std::to_string(count) + " unlimited rays is cast") {
+            scene.Compare(rays.Batch(count, false));
+         }
+      }
+   }
+}
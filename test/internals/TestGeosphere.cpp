@@ -0,0 +1,67 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "../../source/generators/Sphere.inl"
+#include <Langulus/Testing.hpp>
+#include <cmath>
+#include <string>
+
+using Sphere = GenerateSphere<TSphere<Vec3>, A::Triangle>;
+
+
+SCENARIO("Geosphere subdivision", "[sphere]") {
+   for (Count level = 0; level <= Geosphere::PrecomputedLevel + 1; ++level) {
+      GIVEN("Tesselation level " + std::to_string(level)) {
+         // Subdivide the same level from the tables, and entirely at   
+         // runtime, starting from the icosahedron                      
+         TMany<Sphere::PointType> tableVertices, runtimeVertices;
+         TMany<uint32_t> tableIndices, runtimeIndices;
+         Sphere::GetGeosphere(level, tableVertices, tableIndices);
+         Sphere::Subdivide(level, runtimeVertices, runtimeIndices, 0);
+
+         THEN("The counts match the closed form") {
+            REQUIRE(tableVertices.GetCount() == Geosphere::VertexCount(level));
+            REQUIRE(tableIndices.GetCount() == Geosphere::TriangleCount(level) * 3);
+            REQUIRE(runtimeVertices.GetCount() == Geosphere::VertexCount(level));
+            REQUIRE(runtimeIndices.GetCount() == Geosphere::TriangleCount(level) * 3);
+
+            // Every edge is shared by two triangles, and gets a vertex 
+            // in the middle, while every triangle becomes four         
+            REQUIRE(Geosphere::VertexCount(level + 1)
+               == Geosphere::VertexCount(level) + Geosphere::TriangleCount(level) * 3 / 2);
+            REQUIRE(Geosphere::TriangleCount(level + 1)
+               == Geosphere::TriangleCount(level) * 4);
+         }
+
+         THEN("The tables match the runtime subdivision") {
+            REQUIRE(tableIndices == runtimeIndices);
+            for (Offset i = 0; i < tableVertices.GetCount(); ++i) {
+               for (int c = 0; c < 3; ++c)
+                  REQUIRE(std::abs(tableVertices[i][c] - runtimeVertices[i][c]) < 1e-6);
+            }
+         }
+
+         THEN("All vertices are on the sphere, and all are used") {
+            TMany<uint8_t> used;
+            used.Reserve<true>(tableVertices.GetCount());
+            for (auto& u : used)
+               u = 0;
+
+            for (auto index : tableIndices) {
+               REQUIRE(index < tableVertices.GetCount());
+               used[index] = 1;
+            }
+
+            for (Offset i = 0; i < tableVertices.GetCount(); ++i) {
+               const auto& v = tableVertices[i];
+               REQUIRE(used[i]);
+               REQUIRE(std::abs(std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]) - .5) < 1e-6);
+            }
+         }
+      }
+   }
+}
@@ -0,0 +1,112 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "../../source/OBJ.hpp"
+#include "../../source/Scanner.hpp"
+#include <Langulus/Testing.hpp>
+#include <string>
+
+
+/// Generate an OBJ, whose faces refer to vertices relative to the end of the 
+/// ones so far, and whose objects and groups span many lines, so that        
+/// chunks split them wherever they begin                                     
+///   @return the text, followed by Scanner::Padding bytes                    
+static std::string Generate() {
+   std::string text = "mtllib missing.mtl\n";
+   for (int i = 0; i < 64; ++i) {
+      const auto n = std::to_string(i);
+      if (i % 20 == 0)
+         text += "o object" + std::to_string(i / 20) + "\n";
+      if (i % 7 == 0)
+         text += "g group" + std::to_string(i / 7) + "\n";
+      if (i % 11 == 0)
+         text += "usemtl material" + std::to_string(i % 3) + "\n";
+
+      text += "v " + n + " 0 0\nv " + n + " 1 0\nv " + n + " 1 1\nv " + n + " 0 1\n";
+      text += "vt 0 " + n + "\nvt 1 " + n + "\n";
+      text += "vn 0 0 1\n";
+
+      // A quad, split into two triangles                               
+      text += "f -4/-2/-1 -3/-1/-1 -2/-1/-1 -1/-2/-1\n";
+
+      // A triangle, that reaches back to the previous vertices         
+      if (i > 0)
+         text += "f -6/-3 -5/-3 -1/-1\n";
+   }
+
+   text.append(Scanner::Padding, '\0');
+   return text;
+}
+
+/// Parse a buffer as a single chunk, the way streamed files are parsed       
+///   @param ptr - start of the buffer                                        
+///   @param end - end of the buffer, must be right after a newline           
+///   @return the parsed mesh                                                 
+static Obj::Mesh ParseWhole(const char* ptr, const char* end) {
+   Obj::Mesh out, local;
+   Obj::Data data;
+   Obj::begin_chunk(&data, &local, &out.materials, true);
+   Obj::parse_buffer(&data, ptr, end);
+
+   Obj::Merge state;
+   Obj::merge_chunk(out, state, data);
+   Obj::finish_merge(out, state);
+   return out;
+}
+
+/// Check that two lists of objects or groups are the same                    
+///   @param a - the first list                                               
+///   @param b - the second list                                              
+static void Compare(const TMany<Obj::Group>& a, const TMany<Obj::Group>& b) {
+   REQUIRE(a.GetCount() == b.GetCount());
+   for (Offset i = 0; i < a.GetCount(); ++i) {
+      REQUIRE(a[i].name == b[i].name);
+      REQUIRE(a[i].face_count == b[i].face_count);
+      REQUIRE(a[i].face_offset == b[i].face_offset);
+      REQUIRE(a[i].index_offset == b[i].index_offset);
+   }
+}
+
+SCENARIO("Parsing OBJ files in parallel", "[obj]") {
+   GIVEN("Relative indices, and groups that span chunks") {
+      const auto text = Generate();
+      const auto ptr = text.data();
+      const auto end = text.data() + text.size() - Scanner::Padding;
+
+      const auto whole = ParseWhole(ptr, end);
+      REQUIRE(whole.positions.GetCount() == 1 + 64 * 4);
+      REQUIRE(whole.mPositionIndices.GetCount() == (64 * 2 + 63) * 3);
+      REQUIRE(whole.objects.GetCount() == 4);
+      REQUIRE(whole.groups.GetCount() == 10);
+
+      Workers workers;
+      for (size_t chunks : {1, 2, 3, 5, 8, 13}) {
+         WHEN("Parsed in " + std::to_string(chunks) + " chunks") {
+            Obj::Mesh parallel;
+            Obj::parse_parallel(parallel, ptr, end, nullptr, workers, chunks);
+
+            THEN("The result is the same as parsing it in one go") {
+               REQUIRE(parallel.positions == whole.positions);
+               REQUIRE(parallel.texcoords == whole.texcoords);
+               REQUIRE(parallel.normals == whole.normals);
+               REQUIRE(parallel.mPositionIndices == whole.mPositionIndices);
+               REQUIRE(parallel.mTextureIndices == whole.mTextureIndices);
+               REQUIRE(parallel.mNormalIndices == whole.mNormalIndices);
+               REQUIRE(parallel.face_vertices == whole.face_vertices);
+               REQUIRE(parallel.face_materials == whole.face_materials);
+
+               REQUIRE(parallel.materials.GetCount() == whole.materials.GetCount());
+               for (Offset i = 0; i < whole.materials.GetCount(); ++i)
+                  REQUIRE(parallel.materials[i].name == whole.materials[i].name);
+
+               Compare(parallel.objects, whole.objects);
+               Compare(parallel.groups, whole.groups);
+            }
+         }
+      }
+   }
+}
@@ -0,0 +1,177 @@
+///                                                                           
+/// Langulus::Module::Assets::Geometry                                        
+/// Copyright (c) 2016 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "../../source/Weld.hpp"
+#include <Langulus/Testing.hpp>
+#include <cstring>
+
+
+/// Attributes of a mesh, indexed separately, as OBJ files have them          
+struct Separate {
+   TMany<Vec3f> positions;
+   TMany<Vec3f> normals;
+   TMany<Vec2f> texcoords;
+   TMany<Vec3f> colors;
+   TMany<uint32_t> positionIndices;
+   TMany<uint32_t> normalIndices;
+   TMany<uint32_t> textureIndices;
+
+   /// Add a triangle                                                         
+   ///   @param p - the position indices                                      
+   ///   @param n - the normal index, same for all corners                    
+   ///   @param t - the texture coordinate indices                            
+   void Add(const uint32_t (&p)[3], uint32_t n, const uint32_t (&t)[3]) {
+      for (int c = 0; c < 3; ++c) {
+         positionIndices << p[c];
+         normalIndices << n;
+         textureIndices << t[c];
+      }
+   }
+
+   /// Weld the attributes                                                    
+   ///   @param layout - the layout to interleave in, if any                  
+   ///   @return the welded attributes                                        
+   auto Unify(const VertexLayout* layout = nullptr) const {
+      return Weld::Unify(positions, normals, texcoords, colors,
+         positionIndices, normalIndices, textureIndices, layout);
+   }
+};
+
+/// Check that every welded vertex has the attributes it was welded from      
+///   @param in - the separately indexed attributes                           
+///   @param out - the welded attributes                                      
+static void Compare(const Separate& in, const Weld::Result& out) {
+   REQUIRE(out.indices.GetCount() == in.positionIndices.GetCount());
+   for (Offset i = 0; i < out.indices.GetCount(); ++i) {
+      const auto v = out.indices[i];
+      REQUIRE(v < out.positions.GetCount());
+      REQUIRE(out.positions[v] == in.positions[in.positionIndices[i]]);
+      REQUIRE(out.normals[v] == in.normals[in.normalIndices[i]]);
+      REQUIRE(out.texcoords[v] == in.texcoords[in.textureIndices[i]]);
+      if (in.colors)
+         REQUIRE(out.colors[v] == in.colors[in.positionIndices[i]]);
+   }
+}
+
+SCENARIO("Welding separately indexed attributes", "[weld]") {
+   GIVEN("A cube, whose corners are shared by faces of different normals") {
+      Separate cube;
+      for (int i = 0; i < 8; ++i)
+         cube.positions << Vec3f {
+            static_cast<float>(i & 1),
+            static_cast<float>((i >> 1) & 1),
+            static_cast<float>((i >> 2) & 1)
+         };
+      cube.normals << Vec3f {-1, 0, 0} << Vec3f {1, 0, 0}
+                   << Vec3f {0, -1, 0} << Vec3f {0, 1, 0}
+                   << Vec3f {0, 0, -1} << Vec3f {0, 0, 1};
+      cube.texcoords << Vec2f {0, 0} << Vec2f {1, 0}
+                     << Vec2f {1, 1} << Vec2f {0, 1};
+
+      const uint32_t faces[6][4] {
+         {0, 4, 6, 2}, {1, 3, 7, 5},
+         {0, 1, 5, 4}, {2, 6, 7, 3},
+         {0, 2, 3, 1}, {4, 5, 7, 6}
+      };
+
+      for (uint32_t f = 0; f < 6; ++f) {
+         const auto& q = faces[f];
+         cube.Add({q[0], q[1], q[2]}, f, {0, 1, 2});
+         cube.Add({q[0], q[2], q[3]}, f, {0, 2, 3});
+      }
+
+      WHEN("Welded") {
+         const auto welded = cube.Unify();
+
+         THEN("Each corner of each face becomes a vertex") {
+            REQUIRE(welded.positions.GetCount() == 24);
+            REQUIRE(welded.normals.GetCount() == 24);
+            REQUIRE(welded.texcoords.GetCount() == 24);
+            REQUIRE(welded.indices.GetCount() == 36);
+            Compare(cube, welded);
+         }
+      }
+
+      WHEN("Welded and interleaved") {
+         const Count sizes[VertexLayout::AttributeCount] {
+            sizeof(Vec3f), sizeof(Vec3f), sizeof(Vec2f), 0
+         };
+         const auto layout = VertexLayout::Describe(sizes);
+         const auto welded = cube.Unify(&layout);
+
+         THEN("The interleaved vertices match the separate ones") {
+            REQUIRE(welded.positions.GetCount() == 24);
+            REQUIRE(welded.interleaved.GetCount() == 24 * layout.mStride);
+
+            for (Offset v = 0; v < 24; ++v) {
+               const auto vertex = welded.interleaved.GetRaw() + v * layout.mStride;
+               REQUIRE(0 == ::std::memcmp(vertex + layout.mOffsets[VertexLayout::Position],
+                  &welded.positions[v], sizeof(Vec3f)));
+               REQUIRE(0 == ::std::memcmp(vertex + layout.mOffsets[VertexLayout::Normal],
+                  &welded.normals[v], sizeof(Vec3f)));
+               REQUIRE(0 == ::std::memcmp(vertex + layout.mOffsets[VertexLayout::Sampler],
+                  &welded.texcoords[v], sizeof(Vec2f)));
+            }
+         }
+      }
+
+      WHEN("Welded and interleaved with vertex colors") {
+         for (auto& p : cube.positions)
+            cube.colors << p;
+
+         const Count sizes[VertexLayout::AttributeCount] {
+            sizeof(Vec3f), sizeof(Vec3f), sizeof(Vec2f), sizeof(Vec3f)
+         };
+         const auto layout = VertexLayout::Describe(sizes);
+         const auto welded = cube.Unify(&layout);
+
+         THEN("The colors are welded along with their positions") {
+            REQUIRE(welded.colors.GetCount() == 24);
+            Compare(cube, welded);
+
+            for (Offset v = 0; v < 24; ++v) {
+               const auto vertex = welded.interleaved.GetRaw() + v * layout.mStride;
+               REQUIRE(0 == ::std::memcmp(vertex + layout.mOffsets[VertexLayout::Color],
+                  &welded.colors[v], sizeof(Vec3f)));
+            }
+         }
+      }
+   }
+
+   GIVEN("A quad, with a smooth normal") {
+      Separate quad;
+      quad.positions << Vec3f {0, 0, 0} << Vec3f {1, 0, 0}
+                     << Vec3f {1, 1, 0} << Vec3f {0, 1, 0};
+      quad.normals << Vec3f {0, 0, 1};
+      for (int i = 0; i < 6; ++i)
+         quad.texcoords << Vec2f {static_cast<float>(i), 0};
+
+      WHEN("Both triangles share the texture coordinates of their edge") {
+         quad.Add({0, 1, 2}, 0, {0, 1, 2});
+         quad.Add({0, 2, 3}, 0, {0, 2, 3});
+         const auto welded = quad.Unify();
+
+         THEN("The edge is welded") {
+            REQUIRE(welded.positions.GetCount() == 4);
+            REQUIRE(welded.indices.GetCount() == 6);
+            Compare(quad, welded);
+         }
+      }
+
+      WHEN("The triangles meet at a texture seam") {
+         quad.Add({0, 1, 2}, 0, {0, 1, 2});
+         quad.Add({0, 2, 3}, 0, {3, 4, 5});
+         const auto welded = quad.Unify();
+
+         THEN("The edge is split") {
+            REQUIRE(welded.positions.GetCount() == 6);
+            REQUIRE(welded.indices.GetCount() == 6);
+            Compare(quad, welded);
+         }
+      }
+   }
+}